@@ -141,6 +141,22 @@ struct CreateRequestImpl {
         return valueList;
     }
 
+    // digits separated by one or two ':'
+    static bool isSlice(const string& item)
+    {
+        size_t ncolon = 0;
+        for(size_t i=0; i<item.size(); i++) {
+            if(item[i]==':') {
+                if(i==0 || item[i-1]==':')
+                    return false;
+                ncolon++;
+            } else if(item[i]<'0' || item[i]>'9') {
+                return false;
+            }
+        }
+        return (ncolon==1 || ncolon==2) && item[item.size()-1]!=':';
+    }
+
     Node createRequestOptions(
         string const & request)
     {
@@ -153,6 +169,10 @@ struct CreateRequestImpl {
         size_t nitems = items.size();
         for(size_t j=0; j<nitems; j++) {
             string item = items[j];
+            if(item.find('=')==string::npos && isSlice(item)) {
+                // array slice shorthand "start:count[:stride]" for "slice=start:count[:stride]"
+                item = "slice=" + item;
+            }
             size_t equals = item.find('=');
             if(equals==string::npos || equals==0) {
                 throw std::runtime_error(item + " illegal option " + request);
@@ -9,6 +9,7 @@
 #include <string>
 #include <sstream>
 #include <vector>
+#include <map>
 
 #include <pv/pvData.h>
 #include <pv/lock.h>
@@ -57,6 +58,9 @@ protected:
 };
 
 /** Parse and build pvRequest structure.
+ *
+ * An option of the form "start:count" or "start:count:stride", eg. "field(value[0:100])",
+ * is shorthand for "slice=start:count:stride".
  *
  @params request the Request string to be parsed.  eg. "field(value)"
  @returns The resulting strucuture.  Never NULL
@@ -69,10 +73,23 @@ PVStructure::shared_pointer createRequest(std::string const & request);
  *  'field' substructure of a pvRequest.
  *  Copies between an internal (base) Structure, and a client/user visible (requested) Structure.
  *
- * @note PVRequestMapper is not re-entrant.  It is copyable and swap()able.
+ * A variable size scalar array field, or a union field holding one (eg. NTNDArray 'value'),
+ * may be requested with a slice option,
+ * eg. "field(value[slice=10:100:2])" or "field(value[10:100:2])" ,
+ * to copy only 'count' elements starting at 'start', taking every 'stride'th element.
+ * A union holding anything else is copied whole.
+ * 'stride' defaults to 1, in which case the requested array references
+ * part of the base array without copying (see PVScalarArray::copySlice()).
+ * Sliced arrays are not copied by copyBaseFromRequested().
+ *
+ * @note After compute(), the const methods of PVRequestMapper may be called concurrently.
+ *       A computed mapping may be shared between subscribers.  @see cached()
+ *       PVRequestMapper is copyable and swap()able.
  */
 class epicsShareClass PVRequestMapper {
 public:
+    POINTER_DEFINITIONS(PVRequestMapper);
+
     enum mode_t {
         /** Masking mode.
          *
@@ -139,6 +156,23 @@ public:
                  const PVStructure& pvRequest,
                  mode_t mode = Mask);
 
+    /** Find or compute() a shared mapping.
+     *
+     * Mappings are cached by base Structure, pvRequest, and mode,
+     * for as long as a reference returned by cached() is kept.
+     * eg. many subscribers of one PV with the same pvRequest share one mapping.
+     *
+     @code
+     PVRequestMapper::const_shared_pointer mapper(PVRequestMapper::cached(*pv, *pvRequest));
+     @endcode
+     *
+     * @throws std::runtime_error For errors involving invalid pvRequest, as compute()
+     * @version Added after 8.0.0
+     */
+    static const_shared_pointer cached(const PVStructure& base,
+                                       const PVStructure& pvRequest,
+                                       mode_t mode = Mask);
+
     //! After compute(), check if !warnings().empty()
     inline const std::string& warnings() const { return messages; }
 
@@ -194,14 +228,28 @@ public:
     void swap(PVRequestMapper& other);
 
 private:
+    struct ArraySlice {
+        size_t start, count, stride; // stride==0 when not sliced
+        ArraySlice() :start(0u), count(0u), stride(0u) {}
+    };
+    typedef std::map<size_t, ArraySlice> slices_t; // by base field offset
+
     bool _compute(const PVStructure& base, const PVStructure& pvReq,
-                  FieldBuilderPtr& builder, bool keepids, unsigned depth);
+                  FieldBuilderPtr& builder, bool keepids, unsigned depth,
+                  slices_t& slices);
+    void parseSlice(const PVField& fld, const std::string& spec, slices_t& slices);
 
     void _map(const PVStructure& src,
               const BitSet& maskSrc,
               PVStructure& dest,
               BitSet& maskDest,
               bool dir_r2b) const;
+    struct Mapping;
+    void _mapLeaf(const Mapping& M,
+                  const PVField& src,
+                  PVStructure& dest,
+                  BitSet& maskDest,
+                  bool dir_r2b) const;
     void _mapMask(const BitSet& maskSrc,
                   BitSet& maskDest,
                   bool dir_r2b) const;
@@ -216,15 +264,15 @@ private:
                frommask; // if !leaf these are the other bits in the source mask to be copied
         bool valid; // only true in (sparse) base -> requested mapping
         bool leaf; // not a (sub)Structure?
-        Mapping() :valid(false) {}
-        Mapping(size_t to, bool leaf) :to(to), valid(true), leaf(leaf) {}
+        ArraySlice slice; // if leaf, part of an array (or union holding an array) to copy
+        size_t end; // if !leaf, offset following the last source sub-field
+        Mapping() :valid(false), end(0u) {}
+        Mapping(size_t to, bool leaf) :to(to), valid(true), leaf(leaf), end(0u) {}
     };
     typedef std::vector<Mapping> mapping_t;
     mapping_t base2req, req2base;
 
     std::string messages;
-
-    mutable BitSet scratch; // avoid temporary allocs.  (we aren't re-entrant!)
 };
 
 }}
@@ -12,15 +12,58 @@
 #include <epicsAssert.h>
 #include <epicsMutex.h>
 #include <epicsGuard.h>
+#include <epicsThread.h>
 
 #define epicsExportSharedSymbols
 #include <pv/createRequest.h>
 #include <pv/epicsException.h>
 #include <pv/bitSet.h>
+#include <pv/latency.h>
 
 // Our arbitrary limit on pvRequest structure depth to bound stack usage during recursion
 static const unsigned maxDepth = 5;
 
+namespace {
+// A request for a (sub)Structure with no sub-fields, other than options, selects all sub-fields
+bool selectsAll(const epics::pvData::Structure& req)
+{
+    const epics::pvData::StringArray& names = req.getFieldNames();
+    return names.empty() || (names.size()==1u && names[0]=="_options");
+}
+
+using epics::pvData::PVRequestMapper;
+
+// cache key.  The mapper keeps a reference to the base Structure while cached.
+struct MapperKey {
+    const epics::pvData::Structure *base;
+    PVRequestMapper::mode_t mode;
+    std::string request; // pvRequest type and values
+
+    bool operator<(const MapperKey& o) const {
+        if(base!=o.base) return base<o.base;
+        if(mode!=o.mode) return mode<o.mode;
+        return request<o.request;
+    }
+};
+
+struct mappercache_t {
+    epicsMutex lock;
+    typedef std::map<MapperKey, PVRequestMapper::const_weak_pointer> mappers_t;
+    mappers_t mappers;
+};
+
+mappercache_t *mappercache;
+
+void mappercache_init(void *)
+{
+    mappercache = new mappercache_t;
+}
+
+epicsThreadOnceId mappercache_once = EPICS_THREAD_ONCE_INIT;
+
+typedef epicsGuard<epicsMutex> Guard;
+}
+
 namespace epics{namespace pvData {
 
 PVRequestMapper::PVRequestMapper() {}
@@ -32,6 +75,52 @@ PVRequestMapper::PVRequestMapper(const PVStructure &base,
     compute(base, pvRequest, mode);
 }
 
+PVRequestMapper::const_shared_pointer PVRequestMapper::cached(const PVStructure& base,
+                                                             const PVStructure& pvRequest,
+                                                             mode_t mode)
+{
+    epicsThreadOnce(&mappercache_once, &mappercache_init, 0);
+
+    MapperKey key;
+    key.base = base.getStructure().get();
+    key.mode = mode;
+    {
+        std::ostringstream strm;
+        strm<<pvRequest;
+        key.request = strm.str();
+    }
+
+    {
+        Guard G(mappercache->lock);
+        mappercache_t::mappers_t::const_iterator it(mappercache->mappers.find(key));
+        if(it!=mappercache->mappers.end()) {
+            const_shared_pointer ret(it->second.lock());
+            if(ret)
+                return ret;
+        }
+    }
+
+    // compute() without the lock, and don't cache on error
+    const_shared_pointer ret(new PVRequestMapper(base, pvRequest, mode));
+
+    Guard G(mappercache->lock);
+
+    const_shared_pointer other(mappercache->mappers[key].lock());
+    if(other)
+        return other; // concurrent cached() won
+
+    // forget expired mappings
+    for(mappercache_t::mappers_t::iterator it(mappercache->mappers.begin()), end(mappercache->mappers.end()); it!=end;) {
+        if(it->second.expired())
+            mappercache->mappers.erase(it++);
+        else
+            ++it;
+    }
+
+    mappercache->mappers[key] = ret;
+    return ret;
+}
+
 PVStructurePtr PVRequestMapper::buildRequested() const
 {
     if(!typeRequested)
@@ -57,6 +146,7 @@ void PVRequestMapper::compute(const PVStructure &base,
 
     // we want to be transactional, which requires a second copy of everything.
     PVRequestMapper temp;
+    slices_t slices;
 
     // whether to preserve IDs of partial structures.
     bool keepids = false;
@@ -83,7 +173,7 @@ void PVRequestMapper::compute(const PVStructure &base,
         if(keepids)
             builder = builder->setId(base.getStructure()->getID());
 
-        ok &= temp._compute(base, *fields, builder, keepids, 0); // fills in builder
+        ok &= temp._compute(base, *fields, builder, keepids, 0, slices); // fills in builder
 
         temp.typeBase = base.getStructure();
         temp.typeRequested = builder->createStructure();
@@ -106,6 +196,8 @@ void PVRequestMapper::compute(const PVStructure &base,
         // special handling for whole structure mapping.  in part because getSubField(0) isn't allowed
         temp.base2req[0] = Mapping(0, false);
         temp.req2base[0] = Mapping(0, false);
+        temp.base2req[0].end = base.getNextFieldOffset();
+        temp.req2base[0].end = proto->getNextFieldOffset();
 
         // Iterate prototype of requested to map with base field offsets.
         // which is handled as a special case below.
@@ -123,6 +215,14 @@ void PVRequestMapper::compute(const PVStructure &base,
             // initialize mapping when our bit is set
             temp.base2req[b] = Mapping(r, leaf);
             temp.req2base[r] = Mapping(b, leaf);
+            if(!leaf) {
+                temp.base2req[b].end = fld_base->getNextFieldOffset();
+                temp.req2base[r].end = fld_req->getNextFieldOffset();
+            }
+
+            slices_t::const_iterator it(slices.find(b));
+            if(leaf && it!=slices.end())
+                temp.base2req[b].slice = temp.req2base[r].slice = it->second;
 
             // add ourself to all "compress" bit mappings of enclosing structures
             for(const PVStructure *parent = fld_req->getParent(); parent; parent = parent->getParent()) {
@@ -151,7 +251,8 @@ void PVRequestMapper::compute(const PVStructure &base,
 }
 
 bool PVRequestMapper::_compute(const PVStructure& base, const PVStructure& pvReq,
-                               FieldBuilderPtr& builder, bool keepids, unsigned depth)
+                               FieldBuilderPtr& builder, bool keepids, unsigned depth,
+                               slices_t& slices)
 {
     bool ok = true;
     const StringArray& reqNames = pvReq.getStructure()->getFieldNames();
@@ -159,6 +260,9 @@ bool PVRequestMapper::_compute(const PVStructure& base, const PVStructure& pvReq
     for(size_t i=0, N=reqNames.size(); i<N; i++) {
         // iterate through requested fields
 
+        if(reqNames[i]=="_options")
+            continue; // options of the enclosing field, not a sub-field
+
         PVField::const_shared_pointer subtype(base.getSubField(reqNames[i]));
         const FieldConstPtr& subReq = pvReq.getStructure()->getFields()[i];
 
@@ -180,7 +284,7 @@ bool PVRequestMapper::_compute(const PVStructure& base, const PVStructure& pvReq
 
         } else if(depth>=maxDepth // exceeds max recursion depth
                   || subtype->getField()->getType()!=structure // requested field is a leaf
-                  || static_cast<const Structure&>(*subReq).getFieldNames().empty() // requests all sub-fields
+                  || selectsAll(static_cast<const Structure&>(*subReq)) // requests all sub-fields
                   )
         {
             // just add the whole thing
@@ -188,8 +292,13 @@ bool PVRequestMapper::_compute(const PVStructure& base, const PVStructure& pvReq
             for(size_t j=subtype->getFieldOffset(), N=subtype->getNextFieldOffset(); j<N; j++)
                 maskRequested.set(j);
 
+            const PVStructure& fieldReq = static_cast<const PVStructure&>(*pvReq.getPVFields()[i]);
+            PVScalar::const_shared_pointer pslice(fieldReq.getSubField<PVScalar>("_options.slice"));
+            if(pslice)
+                parseSlice(*subtype, pslice->getAs<std::string>(), slices);
+
             if(subtype->getField()->getType()!=structure
-                    && !static_cast<const Structure&>(*subReq).getFieldNames().empty())
+                    && !selectsAll(static_cast<const Structure&>(*subReq)))
             {
                 // attempt to select below a leaf field
                 std::ostringstream msg;
@@ -213,7 +322,7 @@ bool PVRequestMapper::_compute(const PVStructure& base, const PVStructure& pvReq
 
             _compute(substruct,
                      static_cast<const PVStructure&>(*pvReq.getPVFields()[i]),
-                     builder, keepids, depth+1u);
+                     builder, keepids, depth+1u, slices);
 
             builder = builder->endNested();
         }
@@ -221,12 +330,54 @@ bool PVRequestMapper::_compute(const PVStructure& base, const PVStructure& pvReq
     return ok;
 }
 
+void PVRequestMapper::parseSlice(const PVField& fld, const std::string& spec, slices_t& slices)
+{
+    ArraySlice S;
+    S.stride = 1u;
+
+    try {
+        size_t sep1 = spec.find(':'),
+               sep2 = sep1==std::string::npos ? sep1 : spec.find(':', sep1+1);
+        if(sep1==std::string::npos)
+            throw std::runtime_error("expected start:count or start:count:stride");
+
+        S.start = size_t(castUnsafe<uint64>(spec.substr(0, sep1)));
+        if(sep2==std::string::npos) {
+            S.count = size_t(castUnsafe<uint64>(spec.substr(sep1+1)));
+        } else {
+            S.count = size_t(castUnsafe<uint64>(spec.substr(sep1+1, sep2-sep1-1)));
+            S.stride = size_t(castUnsafe<uint64>(spec.substr(sep2+1)));
+        }
+        if(S.stride==0u)
+            throw std::runtime_error("stride must not be zero");
+
+    }catch(std::runtime_error& e){
+        std::ostringstream msg;
+        msg<<"Can't parse slice '"<<spec<<"' : '"<<e.what()<<"' ";
+        messages+=msg.str();
+        return;
+    }
+
+    // a union is sliced when it holds a variable size scalar array
+    const Field& type = *fld.getField();
+    if(type.getType()!=union_ && (type.getType()!=scalarArray
+                                  || static_cast<const Array&>(type).getArraySizeType()==Array::fixed)) {
+        std::ostringstream msg;
+        msg<<"slice only applies to variable size scalar array, or union '"<<fld.getFullName()<<"' ";
+        messages+=msg.str();
+        return;
+    }
+
+    slices[fld.getFieldOffset()] = S;
+}
+
 void PVRequestMapper::copyBaseToRequested(
         const PVStructure& base,
         const BitSet& baseMask,
         PVStructure& request,
         BitSet& requestMask
 ) const {
+    PVD_LATENCY_SCOPE(latencyCopyBaseToRequested, 0);
     assert(base.getStructure()==typeBase);
     assert(request.getStructure()==typeRequested);
     _map(base, baseMask, request, requestMask, false);
@@ -247,33 +398,75 @@ void PVRequestMapper::_map(const PVStructure& src, const BitSet& maskSrc,
                            PVStructure& dest, BitSet& maskDest,
                            bool dir_r2b) const
 {
-    {
-        scratch = maskSrc;
-        const mapping_t& map = dir_r2b ? req2base : base2req;
+    const mapping_t& map = dir_r2b ? req2base : base2req;
 
-        assert(map.size()==src.getNumberFields());
+    assert(map.size()==src.getNumberFields());
 
-        for(int32 i=scratch.nextSetBit(0), N=map.size(); i>=0 && i<N; i=scratch.nextSetBit(i+1)) {
-            const Mapping& M = map[i];
-            if(!M.valid) {
-                assert(!dir_r2b); // only base -> requested mapping can have holes
+    for(int32 i=maskSrc.nextSetBit(0), N=map.size(); i>=0 && i<N; ) {
+        const Mapping& M = map[i];
+        if(!M.valid) {
+            assert(!dir_r2b); // only base -> requested mapping can have holes
 
-            } else if(M.leaf) {
-                // just copy
-                dest.getSubFieldT(M.to)->copy(*src.getSubFieldT(i));
-                maskDest.set(M.to);
+        } else if(M.leaf) {
+            _mapLeaf(M, *src.getSubFieldT(i), dest, maskDest, dir_r2b);
 
-            } else {
-                // set bits of all sub-fields (in requested structure)
-                // these indicies are always >i
-                scratch |= M.frommask;
+        } else {
+            // if a compress bit is set in the input, then set the corresponding bit in the output.
+            maskDest.set(M.to);
+
+            // copy all selected sub-fields.  these indicies are always >i
+            for(int32 j=M.frommask.nextSetBit(i+1); j>=0; j=M.frommask.nextSetBit(j+1)) {
+                const Mapping& S = map[j];
+                if(S.leaf)
+                    _mapLeaf(S, *src.getSubFieldT(j), dest, maskDest, dir_r2b);
+                else
+                    maskDest.set(S.to);
+            }
 
-                // we will also set the individual bits, but if a compress bit is set in the input,
-                // then set the corresponding bit in the output.
-                maskDest.set(M.to);
+            // skip over sub-fields already copied
+            i = M.end<size_t(N) ? maskSrc.nextSetBit(M.end) : -1;
+            continue;
+        }
+        i = maskSrc.nextSetBit(i+1);
+    }
+}
+
+void PVRequestMapper::_mapLeaf(const Mapping& M, const PVField& src,
+                               PVStructure& dest, BitSet& maskDest,
+                               bool dir_r2b) const
+{
+    if(M.slice.stride) {
+        if(dir_r2b)
+            return; // sliced arrays are not copied back to base
+
+        PVField& fld = *dest.getSubFieldT(M.to);
+        if(src.getField()->getType()==scalarArray) {
+            static_cast<PVScalarArray&>(fld).copySlice(
+                        static_cast<const PVScalarArray&>(src),
+                        M.slice.start, M.slice.count, M.slice.stride);
+
+        } else {
+            // a union, which may hold a variable size scalar array
+            const PVUnion& usrc = static_cast<const PVUnion&>(src);
+            PVUnion& udest = static_cast<PVUnion&>(fld);
+            PVScalarArray::const_shared_pointer asrc(usrc.get<PVScalarArray>());
+
+            if(!asrc || asrc->getScalarArray()->getArraySizeType()==Array::fixed) {
+                udest.copyUnchecked(usrc);
+            } else {
+                PVScalarArray::shared_pointer adest(udest.get<PVScalarArray>());
+                if(!adest || adest->getField()!=asrc->getField())
+                    adest = getPVDataCreate()->createPVScalarArray(asrc->getScalarArray());
+                adest->copySlice(*asrc, M.slice.start, M.slice.count, M.slice.stride);
+                udest.set(usrc.getSelectedIndex(), adest);
             }
         }
+
+    } else {
+        // just copy
+        dest.getSubFieldT(M.to)->copy(src);
     }
+    maskDest.set(M.to);
 }
 
 void PVRequestMapper::_mapMask(const BitSet& maskSrc,
@@ -311,7 +504,6 @@ void PVRequestMapper::swap(PVRequestMapper& other)
     base2req.swap(other.base2req);
     req2base.swap(other.req2base);
     messages.swap(other.messages);
-    scratch.swap(other.scratch); // paranoia
 }
 
 void PVRequestMapper::reset()
@@ -322,7 +514,6 @@ void PVRequestMapper::reset()
     base2req.clear();
     req2base.clear();
     messages.clear();
-    scratch.clear(); // paranoia
 }
 
 }} //namespace epics::pvData
@@ -9,9 +9,12 @@
 #include <algorithm>
 #include <iterator>
 #include <sstream>
+#include <limits>
+#include <cstring>
 
 #define epicsExportSharedSymbols
 #include <pv/pvData.h>
+#include <pv/bitSet.h>
 
 using std::string;
 
@@ -156,9 +159,18 @@ template<typename T>
 bool compareArray(const PVValueArray<T>* left, const PVValueArray<T>* right)
 {
     typename PVValueArray<T>::const_svector lhs(left->view()), rhs(right->view());
-    return std::equal(lhs.begin(), lhs.end(), rhs.begin());
+    if(lhs.size()!=rhs.size())
+        return false;
+    else if(lhs.empty() || lhs.data()==rhs.data())
+        return true; // shared storage
+    else if(std::numeric_limits<T>::is_integer)
+        return memcmp(lhs.data(), rhs.data(), lhs.size()*sizeof(T))==0;
+    else // floating point (NaN!=NaN, 0.0==-0.0) and string
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin());
 }
 
+bool compareValue(const PVField& left, const PVField& right, BitSet *changed);
+
 // partially typed comparisons
 
 bool compareField(const PVScalar* left, const PVScalar* right)
@@ -216,21 +228,28 @@ bool compareField(const PVScalarArray* left, const PVScalarArray* right)
     throw std::logic_error("PVScalarArray with invalid element type!");
 }
 
-bool compareField(const PVStructure* left, const PVStructure* right)
+bool compareField(const PVStructure* left, const PVStructure* right, BitSet *changed)
 {
     StructureConstPtr ls = left->getStructure();
 
-    if(*ls!=*right->getStructure())
+    if(*ls!=*right->getStructure()) {
+        if(changed)
+            changed->set(left->getFieldOffset());
         return false;
+    }
 
     const PVFieldPtrArray& lf = left->getPVFields();
     const PVFieldPtrArray& rf = right->getPVFields();
 
+    bool equal = true;
     for(size_t i=0, nfld=ls->getNumberFields(); i<nfld; i++) {
-        if(*lf[i]!=*rf[i])
-            return false;
+        if(!compareValue(*lf[i], *rf[i], changed)) {
+            equal = false;
+            if(!changed)
+                break;
+        }
     }
-    return true;
+    return equal;
 }
 
 bool compareField(const PVStructureArray* left, const PVStructureArray* right)
@@ -243,6 +262,8 @@ bool compareField(const PVStructureArray* left, const PVStructureArray* right)
 
     if(ld.size()!=rd.size())
         return false;
+    else if(ld.data()==rd.data())
+        return true; // shared storage
 
     PVStructureArray::const_svector::const_iterator lit, lend, rit;
 
@@ -302,6 +323,8 @@ bool compareField(const PVUnionArray* left, const PVUnionArray* right)
 
     if(ld.size()!=rd.size())
         return false;
+    else if(ld.data()==rd.data())
+        return true; // shared storage
 
     PVUnionArray::const_svector::const_iterator lit, lend, rit;
 
@@ -321,28 +344,45 @@ bool compareField(const PVUnionArray* left, const PVUnionArray* right)
     return true;
 }
 
-} // end namespace
-
-// untyped comparison
-
-bool operator==(const PVField& left, const PVField& right)
+// untyped comparison.
+// When 'changed' is not NULL, continue past the first difference
+// and mark the offset of each (leaf) field which differs.
+bool compareValue(const PVField& left, const PVField& right, BitSet *changed)
 {
     if(&left == &right)
         return true;
 
     Type lht = left.getField()->getType();
-    if(lht != right.getField()->getType())
-        return false;
-
-    switch(lht) {
-    case scalar: return compareField(static_cast<const PVScalar*>(&left), static_cast<const PVScalar*>(&right));
-    case scalarArray: return compareField(static_cast<const PVScalarArray*>(&left), static_cast<const PVScalarArray*>(&right));
-    case structure: return compareField(static_cast<const PVStructure*>(&left), static_cast<const PVStructure*>(&right));
-    case structureArray: return compareField(static_cast<const PVStructureArray*>(&left), static_cast<const PVStructureArray*>(&right));
-    case union_: return compareField(static_cast<const PVUnion*>(&left), static_cast<const PVUnion*>(&right));
-    case unionArray: return compareField(static_cast<const PVUnionArray*>(&left), static_cast<const PVUnionArray*>(&right));
+    bool equal;
+    if(lht != right.getField()->getType()) {
+        equal = false;
+    } else {
+        switch(lht) {
+        case scalar: equal = compareField(static_cast<const PVScalar*>(&left), static_cast<const PVScalar*>(&right)); break;
+        case scalarArray: equal = compareField(static_cast<const PVScalarArray*>(&left), static_cast<const PVScalarArray*>(&right)); break;
+        case structure: return compareField(static_cast<const PVStructure*>(&left), static_cast<const PVStructure*>(&right), changed);
+        case structureArray: equal = compareField(static_cast<const PVStructureArray*>(&left), static_cast<const PVStructureArray*>(&right)); break;
+        case union_: equal = compareField(static_cast<const PVUnion*>(&left), static_cast<const PVUnion*>(&right)); break;
+        case unionArray: equal = compareField(static_cast<const PVUnionArray*>(&left), static_cast<const PVUnionArray*>(&right)); break;
+        default:
+            throw std::logic_error("PVField with invalid type!");
+        }
     }
-    throw std::logic_error("PVField with invalid type!");
+    if(!equal && changed)
+        changed->set(left.getFieldOffset());
+    return equal;
+}
+
+} // end namespace
+
+bool operator==(const PVField& left, const PVField& right)
+{
+    return compareValue(left, right, 0);
+}
+
+bool compareValues(const PVField& left, const PVField& right, BitSet& changed)
+{
+    return compareValue(left, right, &changed);
 }
 
 }} // namespace epics::pvData
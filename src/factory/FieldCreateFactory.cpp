@@ -26,6 +26,7 @@
 #include <pv/serializeHelper.h>
 #include <pv/thread.h>
 #include <pv/pvData.h>
+#include <pv/latency.h>
 
 using std::tr1::static_pointer_cast;
 using std::size_t;
@@ -34,6 +35,7 @@ using std::string;
 namespace epics { namespace pvData {
 
 size_t Field::num_instances;
+epics::ShardedCounter Field::num_instances_sharded;
 
 
 struct Field::Helper {
@@ -82,11 +84,11 @@ Field::Field(Type type)
     : m_fieldType(type)
     , m_hash(0)
 {
-    REFTRACE_INCREMENT(num_instances);
+    REFTRACE_INCREMENT(num_instances_sharded);
 }
 
 Field::~Field() {
-    REFTRACE_DECREMENT(num_instances);
+    REFTRACE_DECREMENT(num_instances_sharded);
     FieldCreatePtr create(getFieldCreate());
 
     Lock G(create->mutex);
@@ -1444,6 +1446,7 @@ static int decodeScalar(int8 code)
 
 FieldConstPtr FieldCreate::deserialize(ByteBuffer* buffer, DeserializableControl* control) const
 {
+    PVD_LATENCY_SCOPE(latencyFieldDeserialize, buffer);
     control->ensureData(1);
     int8 code = buffer->getByte();
     if (code == -1)
@@ -1569,7 +1572,7 @@ namespace detail {
 struct field_factory {
     FieldCreatePtr fieldCreate;
     field_factory() :fieldCreate(new FieldCreate()) {
-        registerRefCounter("Field", &Field::num_instances);
+        registerRefCounter("Field", &Field::num_instances_sharded);
         registerRefCounter("Thread", &Thread::num_instances);
     }
 };
@@ -1580,6 +1583,8 @@ static epicsThreadOnceId field_factory_once = EPICS_THREAD_ONCE_INIT;
 
 static void field_factory_init(void*)
 {
+    // before any instances are created
+    Field::num_instances_sharded.setTotal(&Field::num_instances);
     try {
         field_factory_s = new detail::field_factory;
     }catch(std::exception& e){
@@ -98,9 +98,14 @@ void PVScalarValue<T>::copyUnchecked(const PVScalar& from)
 {
     if(this==&from)
         return;
-    T result;
-    from.getAs((void*)&result, typeCode);
-    put(result);
+    if(from.getScalar()->getScalarType()==typeCode) {
+        // same type, skip conversion
+        put(static_cast<const PVScalarValue<T>&>(from).get());
+    } else {
+        T result;
+        from.getAs((void*)&result, typeCode);
+        put(result);
+    }
 }
 
 template<typename T>
@@ -197,7 +202,8 @@ PVValueArray<T>::PVValueArray(ScalarArrayConstPtr const & scalarArray)
 PVValueArray<PVStructurePtr>::PVValueArray(StructureArrayConstPtr const & structureArray)
     :base_t(structureArray)
     ,structureArray(structureArray)
-
+    ,rows(0u)
+    ,columnar(false)
 {}
 
 PVValueArray<PVUnionPtr>::PVValueArray(UnionArrayConstPtr const & unionArray)
@@ -208,6 +214,149 @@ PVValueArray<PVUnionPtr>::PVValueArray(UnionArrayConstPtr const & unionArray)
 template<typename T>
 PVValueArray<T>::~PVValueArray() {}
 
+template<typename T>
+void PVValueArray<T>::promote()
+{
+    if(inlineValue.count) {
+        value = inlineValue.copy();
+        inlineValue.count = 0u;
+
+    } else if(!chunks.empty()) {
+        value = chunks.flatten();
+        chunks.clear();
+
+    } else if(ring.capacity()) {
+        value = ring.flatten();
+        circular_vector<T>().swap(ring);
+    }
+}
+
+template<typename T>
+void PVValueArray<T>::setCircular(size_t capacity)
+{
+    if(this->isImmutable())
+        THROW_EXCEPTION2(std::logic_error, "immutable");
+
+    if(capacity==0u) {
+        promote();
+        return;
+    }
+    this->checkLength(capacity);
+
+    if(ring.capacity()) {
+        ring.reserve(capacity);
+    } else {
+        const const_svector prev(view());
+        circular_vector<T>(capacity).swap(ring);
+        ring.push_back(prev.data(), prev.size());
+        value.clear();
+        inlineValue.count = 0u;
+        chunks.clear();
+    }
+    this->postPut();
+}
+
+template<typename T>
+void PVValueArray<T>::push(const T& next)
+{
+    if(this->isImmutable())
+        THROW_EXCEPTION2(std::logic_error, "immutable");
+    else if(!ring.capacity())
+        THROW_EXCEPTION2(std::logic_error, "not circular");
+
+    ring.push_back(next);
+    this->postPut();
+}
+
+template<typename T>
+void PVValueArray<T>::spans(const_svector& first, const_svector& second) const
+{
+    if(ring.capacity()) {
+        ring.spans(first, second);
+    } else {
+        first = view();
+        second.clear();
+    }
+}
+
+template<typename T>
+void PVValueArray<T>::append(const const_svector& more)
+{
+    if(this->isImmutable())
+        THROW_EXCEPTION2(std::logic_error, "immutable");
+
+    if(ring.capacity()) {
+        ring.push_back(more.data(), more.size());
+        this->postPut();
+        return;
+    }
+
+    this->checkLength(this->getLength()+more.size());
+
+    if(chunks.empty()) {
+        // current contents become the first segment
+        chunks.push_back(inlineValue.count ? inlineValue.copy() : value);
+        inlineValue.count = 0u;
+        value.clear();
+    }
+    chunks.append(more);
+    this->postPut();
+}
+
+template<typename T>
+void PVValueArray<T>::dropFront(size_t n)
+{
+    if(this->isImmutable())
+        THROW_EXCEPTION2(std::logic_error, "immutable");
+
+    const size_t length = this->getLength();
+    if(n > length)
+        n = length;
+    this->checkLength(length-n);
+
+    if(inlineValue.count) {
+        std::copy(inlineValue.data()+n, inlineValue.data()+inlineValue.count, inlineValue.data());
+        inlineValue.count -= n;
+    } else if(!chunks.empty()) {
+        chunks.pop_front(n);
+    } else if(ring.capacity()) {
+        ring.pop_front(n);
+    } else {
+        value.slice(n);
+    }
+    this->postPut();
+}
+
+template<typename T>
+void PVValueArray<T>::dropBack(size_t n)
+{
+    if(this->isImmutable())
+        THROW_EXCEPTION2(std::logic_error, "immutable");
+
+    const size_t length = this->getLength();
+    if(n > length)
+        n = length;
+    this->checkLength(length-n);
+
+    if(inlineValue.count) {
+        inlineValue.count -= n;
+    } else if(!chunks.empty()) {
+        chunks.pop_back(n);
+    } else if(ring.capacity()) {
+        ring.pop_back(n);
+    } else {
+        value.slice(0, length-n);
+    }
+    this->postPut();
+}
+
+template<typename T>
+void PVValueArray<T>::flatten()
+{
+    if(!chunks.empty())
+        promote();
+}
+
 template<typename T>
 ArrayConstPtr PVValueArray<T>::getArray() const
 {
@@ -263,6 +412,13 @@ void PVValueArray<T>::setCapacity(size_t capacity)
 {
     if(this->isCapacityMutable()) {
         this->checkLength(capacity);
+        if(ring.capacity() && capacity) {
+            ring.reserve(capacity);
+            return;
+        }
+        if(inlineValue.count && capacity<=size_t(inline_t::capacity))
+            return;
+        promote();
         value.reserve(capacity);
     }
     else
@@ -275,11 +431,34 @@ void PVValueArray<T>::setLength(size_t length)
     if(this->isImmutable())
         THROW_EXCEPTION2(std::logic_error, "immutable");
 
-    if (length == value.size())
+    const size_t prev = this->getLength();
+    if (length == prev)
         return;
 
     this->checkLength(length);
 
+    if(ring.capacity())
+        promote();
+
+    if(!chunks.empty() && length < prev) {
+        chunks.pop_back(prev-length);
+        return;
+    }
+
+    if(chunks.empty() && length <= size_t(inline_t::capacity) && (inlineValue.count || length > value.size())) {
+        // (re)fill inline storage, instead of growing 'value'
+        if(!inlineValue.count) {
+            std::copy(value.begin(), value.end(), inlineValue.data());
+            value.clear();
+        }
+        if(length > prev)
+            std::fill(inlineValue.data()+prev, inlineValue.data()+length, T());
+        inlineValue.count = length;
+        return;
+    }
+
+    promote();
+
     if (length < value.size())
         value.slice(0, length);
     else
@@ -292,6 +471,9 @@ void PVValueArray<T>::replace(const const_svector& next)
     this->checkLength(next.size());
 
     value = next;
+    inlineValue.count = 0u;
+    chunks.clear();
+    circular_vector<T>().swap(ring);
     this->postPut();
 }
 
@@ -303,6 +485,7 @@ void PVValueArray<T>::swap(const_svector &other)
 
     // no checkLength call here
 
+    promote();
     value.swap(other);
 }
 
@@ -321,16 +504,38 @@ void PVValueArray<T>::deserialize(ByteBuffer *pbuffer,
                 this->getArray()->getMaximumCapacity() :
                 SerializeHelper::readSize(pbuffer, pcontrol);
 
-    svector nextvalue(thaw(value));
-    nextvalue.resize(size); // TODO: avoid copy of stuff we will then overwrite
-
-    T* cur = nextvalue.data();
+    chunks.clear();
+    circular_vector<T>().swap(ring);
+    svector nextvalue;
+    T* cur;
+    const bool small = size>0u && size <= size_t(inline_t::capacity);
+    if(small) {
+        // store inline, dropping our reference to any previous array
+        value.clear();
+        inlineValue.count = 0u;
+        cur = inlineValue.data();
+    } else {
+        inlineValue.count = 0u;
+        // re-use our array only if no one else references it.
+        // Otherwise thaw() would copy elements which are about to be overwritten.
+        if(value.unique())
+            nextvalue = thaw(value);
+        else
+            value.clear();
+        // every element is overwritten below
+        nextvalue.resize_uninitialized(size);
+        cur = nextvalue.data();
+    }
 
     // try to avoid deserializing from the buffer
     // this is only possible if we do not need to do endian-swapping
     if (!pbuffer->reverse<T>())
         if (pcontrol->directDeserialize(pbuffer, (char*)cur, size, sizeof(T)))
         {
+        if(small)
+            inlineValue.count = size;
+        else
+            value = freeze(nextvalue);
         // inform about the change?
         PVField::postPut();
         return;
@@ -356,29 +561,21 @@ void PVValueArray<T>::deserialize(ByteBuffer *pbuffer,
         cur += n2read;
         remaining -= n2read;
     }
-    value = freeze(nextvalue);
+    if(small)
+        inlineValue.count = size;
+    else
+        value = freeze(nextvalue);
     // TODO !!!
     // inform about the change?
     PVField::postPut();
 }
 
+namespace {
+// serialize 'count' elements starting at 'cur'
 template<typename T>
-void PVValueArray<T>::serialize(ByteBuffer *pbuffer,
-        SerializableControl *pflusher, size_t offset, size_t count) const
+void serializeElements(ByteBuffer *pbuffer, SerializableControl *pflusher,
+                       const T* cur, size_t count)
 {
-    //TODO: avoid incrementing the ref counter...
-    const_svector temp(value);
-    temp.slice(offset, count);
-    count = temp.size();
-
-    ArrayConstPtr array = this->getArray();
-    if (array->getArraySizeType() != Array::fixed)
-        SerializeHelper::writeSize(count, pbuffer, pflusher);
-    else if (count != array->getMaximumCapacity())
-        throw std::length_error("fixed array cannot be partially serialized");
-
-    const T* cur = temp.data();
-
     // try to avoid copying into the buffer
     // this is only possible if we do not need to do endian-swapping
     if (!pbuffer->reverse<T>())
@@ -404,6 +601,67 @@ void PVValueArray<T>::serialize(ByteBuffer *pbuffer,
     }
 }
 
+void serializeElements(ByteBuffer *pbuffer, SerializableControl *pflusher,
+                       const string* cur, size_t count)
+{
+    for(size_t i = 0; i<count; i++) {
+        SerializeHelper::serializeString(cur[i], pbuffer, pflusher);
+    }
+}
+
+// serialize 'count' elements starting at 'offset', segment by segment
+template<typename Iter>
+void serializeSegments(ByteBuffer *pbuffer, SerializableControl *pflusher,
+                       Iter it, Iter end, size_t offset, size_t count)
+{
+    for(; count && it!=end; ++it) {
+        if(offset >= it->size()) {
+            offset -= it->size();
+            continue;
+        }
+        const size_t n = std::min(count, it->size()-offset);
+        serializeElements(pbuffer, pflusher, it->data()+offset, n);
+        offset = 0u;
+        count -= n;
+    }
+}
+} // namespace
+
+template<typename T>
+void PVValueArray<T>::serialize(ByteBuffer *pbuffer,
+        SerializableControl *pflusher, size_t offset, size_t count) const
+{
+    // as shared_vector::slice()
+    const size_t length = this->getLength();
+    if(offset > length)
+        offset = length;
+    if(count > length-offset)
+        count = length-offset;
+
+    ArrayConstPtr array = this->getArray();
+    if (array->getArraySizeType() != Array::fixed)
+        SerializeHelper::writeSize(count, pbuffer, pflusher);
+    else if (count != array->getMaximumCapacity())
+        throw std::length_error("fixed array cannot be partially serialized");
+
+    if(inlineValue.count) {
+        serializeElements(pbuffer, pflusher, inlineValue.data()+offset, count);
+
+    } else if(!chunks.empty()) {
+        serializeSegments(pbuffer, pflusher, chunks.begin(), chunks.end(), offset, count);
+
+    } else if(ring.capacity()) {
+        const_svector segs[2];
+        ring.spans(segs[0], segs[1]);
+        serializeSegments(pbuffer, pflusher, segs, segs+2, offset, count);
+
+    } else {
+        //TODO: avoid incrementing the ref counter...
+        const_svector temp(value);
+        serializeElements(pbuffer, pflusher, temp.data()+offset, count);
+    }
+}
+
 // specializations for string
 
 template<>
@@ -414,11 +672,18 @@ void PVValueArray<string>::deserialize(ByteBuffer *pbuffer,
                 this->getArray()->getMaximumCapacity() :
                 SerializeHelper::readSize(pbuffer, pcontrol);
 
-    svector nextvalue(thaw(value));
+    chunks.clear();
+    circular_vector<string>().swap(ring);
+    svector nextvalue;
+    // re-use our array only if no one else references it, without copying elements
+    if(value.unique())
+        nextvalue = thaw(value);
+    else
+        value.clear();
 
     // Decide if we must re-allocate
-    if(size > nextvalue.size() || !nextvalue.unique())
-        nextvalue.resize(size);
+    if(size > nextvalue.size())
+        nextvalue.resize_uninitialized(size);
     else if(size < nextvalue.size())
         nextvalue.slice(0, size);
 
@@ -437,6 +702,26 @@ template<>
 void PVValueArray<string>::serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher, size_t offset, size_t count) const {
 
+    if(!chunks.empty() || ring.capacity()) {
+        const size_t length = this->getLength();
+        if(offset > length)
+            offset = length;
+        if(count > length-offset)
+            count = length-offset;
+
+        if (this->getArray()->getArraySizeType() != Array::fixed)
+            SerializeHelper::writeSize(count, pbuffer, pflusher);
+
+        if(!chunks.empty()) {
+            serializeSegments(pbuffer, pflusher, chunks.begin(), chunks.end(), offset, count);
+        } else {
+            const_svector segs[2];
+            ring.spans(segs[0], segs[1]);
+            serializeSegments(pbuffer, pflusher, segs, segs+2, offset, count);
+        }
+        return;
+    }
+
     const_svector temp(value);
     temp.slice(offset, count);
 
@@ -444,10 +729,7 @@ void PVValueArray<string>::serialize(ByteBuffer *pbuffer,
     if (this->getArray()->getArraySizeType() != Array::fixed)
         SerializeHelper::writeSize(temp.size(), pbuffer, pflusher);
 
-    const string * pvalue = temp.data();
-    for(size_t i = 0; i<temp.size(); i++) {
-        SerializeHelper::serializeString(pvalue[i], pbuffer, pflusher);
-    }
+    serializeElements(pbuffer, pflusher, temp.data(), temp.size());
 }
 
 template<typename T>
@@ -459,9 +741,51 @@ void PVValueArray<T>::_getAsVoid(epics::pvData::shared_vector<const void>& out)
 template<typename T>
 void PVValueArray<T>::_putFromVoid(const epics::pvData::shared_vector<const void>& in)
 {
+    const ScalarType stype = in.original_type();
+    if(size_t(inline_t::capacity)>0u && stype!=typeCode && stype>=pvBoolean && stype<=pvString) {
+        const size_t count = in.size()/ScalarTypeFunc::elementSize(stype);
+        if(count>0u && count<=size_t(inline_t::capacity)) {
+            // convert into inline storage, instead of allocating
+            this->checkLength(count);
+            T temp[inline_t::capacity>0 ? size_t(inline_t::capacity) : 1u];
+            castUnsafeV(count, typeCode, static_cast<void*>(temp), stype, in.data());
+            std::copy(temp, temp+count, inlineValue.data());
+            value.clear();
+            chunks.clear();
+            circular_vector<T>().swap(ring);
+            inlineValue.count = count;
+            this->postPut();
+            return;
+        }
+    }
     this->replace(shared_vector_convert<const T>(in));
 }
 
+template<typename T>
+bool PVValueArray<T>::_copyStorage(const PVScalarArray& from)
+{
+    const PVValueArray *src = dynamic_cast<const PVValueArray*>(&from);
+    if(!src || (!src->inlineValue.count && src->chunks.nsegments()<=1u))
+        return false;
+
+    this->checkLength(src->getLength());
+    if(src->inlineValue.count) {
+        // copy inline to inline, instead of allocating in view()
+        std::copy(src->inlineValue.data(), src->inlineValue.data()+src->inlineValue.count, inlineValue.data());
+        chunks.clear();
+    } else {
+        // share segments, instead of joining them in view()
+        chunked_vector<T> temp;
+        temp.push_back(src->chunks);
+        chunks.swap(temp);
+    }
+    value.clear();
+    circular_vector<T>().swap(ring);
+    inlineValue.count = src->inlineValue.count;
+    this->postPut();
+    return true;
+}
+
 // Factory
 
 PVDataCreate::PVDataCreate()
@@ -719,7 +1043,7 @@ namespace detail {
 struct pvfield_factory {
     PVDataCreatePtr pvDataCreate;
     pvfield_factory() :pvDataCreate(new PVDataCreate()) {
-        registerRefCounter("PVField", &PVField::num_instances);
+        registerRefCounter("PVField", &PVField::num_instances_sharded);
     }
 };
 }
@@ -729,6 +1053,8 @@ static epicsThreadOnceId pvfield_factory_once = EPICS_THREAD_ONCE_INIT;
 
 static void pvfield_factory_init(void*)
 {
+    // before any instances are created
+    PVField::num_instances_sharded.setTotal(&PVField::num_instances);
     try {
         pvfield_factory_s = new detail::pvfield_factory;
     }catch(std::exception& e){
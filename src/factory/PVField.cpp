@@ -26,18 +26,19 @@ using std::string;
 namespace epics { namespace pvData {
 
 size_t PVField::num_instances;
+epics::ShardedCounter PVField::num_instances_sharded;
 
 PVField::PVField(FieldConstPtr field)
 : parent(NULL),field(field),
   fieldOffset(0), nextFieldOffset(0),
   immutable(false)
 {
-    REFTRACE_INCREMENT(num_instances);
+    REFTRACE_INCREMENT(num_instances_sharded);
 }
 
 PVField::~PVField()
 {
-    REFTRACE_DECREMENT(num_instances);
+    REFTRACE_DECREMENT(num_instances_sharded);
 }
 
 
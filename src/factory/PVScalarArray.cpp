@@ -17,6 +17,20 @@
 
 using std::tr1::static_pointer_cast;using std::tr1::static_pointer_cast;
 
+namespace {
+using namespace epics::pvData;
+
+template<typename T>
+void copyStrided(void *dest, const void *src, size_t count, size_t stride)
+{
+    T *out = static_cast<T*>(dest);
+    const T *in = static_cast<const T*>(src);
+    for(size_t i=0; i<count; i++, in+=stride)
+        out[i] = *in;
+}
+
+} // namespace
+
 namespace epics { namespace pvData {
 
     PVScalarArray::~PVScalarArray() {}
@@ -29,4 +43,62 @@ namespace epics { namespace pvData {
        return static_pointer_cast<const ScalarArray>(PVField::getField());
     }
 
+    bool PVScalarArray::_copyStorage(const PVScalarArray&)
+    {
+        return false;
+    }
+
+    void PVScalarArray::copySlice(const PVScalarArray& from, size_t offset, size_t count, size_t stride)
+    {
+        if (isImmutable())
+            throw std::invalid_argument("destination is immutable");
+        if (stride==0u)
+            throw std::invalid_argument("slice stride must not be zero");
+
+        shared_vector<const void> temp;
+        from._getAsVoid(temp);
+
+        const ScalarType stype = temp.original_type();
+        const size_t esize = ScalarTypeFunc::elementSize(stype);
+        const size_t length = temp.size()/esize;
+
+        if(offset > length)
+            offset = length;
+        // number of elements which can be selected
+        const size_t avail = length==offset ? 0u : 1u + (length - offset - 1u)/stride;
+        if(count > avail)
+            count = avail;
+
+        if(stride==1u) {
+            // a reference to part of the source array
+            temp.slice(offset*esize, count*esize);
+            _putFromVoid(temp);
+            return;
+        }
+
+        shared_vector<void> out(ScalarTypeFunc::allocArray(stype, count));
+        const void *start = static_cast<const char*>(temp.data()) + offset*esize;
+
+        switch(stype) {
+#define OP(ENUM, TYPE) case ENUM: copyStrided<TYPE>(out.data(), start, count, stride); break
+        OP(pvBoolean, boolean);
+        OP(pvUByte, uint8);
+        OP(pvByte, int8);
+        OP(pvUShort, uint16);
+        OP(pvShort, int16);
+        OP(pvUInt, uint32);
+        OP(pvInt, int32);
+        OP(pvULong, uint64);
+        OP(pvLong, int64);
+        OP(pvFloat, float);
+        OP(pvDouble, double);
+        OP(pvString, std::string);
+#undef OP
+        default:
+            THROW_EXCEPTION2(std::invalid_argument, "error unknown ScalarType");
+        }
+
+        _putFromVoid(freeze(out));
+    }
+
 }}
@@ -17,6 +17,7 @@
 #include <pv/pvIntrospect.h>
 #include <pv/factory.h>
 #include <pv/bitSet.h>
+#include <pv/latency.h>
 
 using std::tr1::static_pointer_cast;
 using std::size_t;
@@ -217,6 +218,7 @@ void PVStructure::throwBadFieldType(std::size_t fieldOffset)
 
 void PVStructure::serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher) const {
+    PVD_LATENCY_SCOPE(latencySerialize, pbuffer);
     size_t fieldsSize = pvFields.size();
     for(size_t i = 0; i<fieldsSize; i++)
         pvFields[i]->serialize(pbuffer, pflusher);
@@ -224,6 +226,7 @@ void PVStructure::serialize(ByteBuffer *pbuffer,
 
 void PVStructure::deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pcontrol) {
+    PVD_LATENCY_SCOPE(latencyDeserialize, pbuffer);
     size_t fieldsSize = pvFields.size();
     for(size_t i = 0; i<fieldsSize; i++)
         pvFields[i]->deserialize(pbuffer, pcontrol);
@@ -232,6 +235,7 @@ void PVStructure::deserialize(ByteBuffer *pbuffer,
 
 void PVStructure::serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher, BitSet *pbitSet) const {
+    PVD_LATENCY_SCOPE(latencySerializeBitSet, pbuffer);
     size_t numberFields = this->getNumberFields();
     size_t offset = this->getFieldOffset();
     int32 next = pbitSet->nextSetBit(static_cast<uint32>(offset));
@@ -268,6 +272,7 @@ void PVStructure::serialize(ByteBuffer *pbuffer,
 
 void PVStructure::deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pcontrol, BitSet *pbitSet) {
+    PVD_LATENCY_SCOPE(latencyDeserializeBitSet, pbuffer);
     size_t offset = getFieldOffset();
     size_t numberFields = getNumberFields();
     int32 next = pbitSet->nextSetBit(static_cast<uint32>(offset));
@@ -347,7 +352,20 @@ void PVStructure::copyUnchecked(const PVStructure& from)
 
     size_t fieldsSize = fromPVFields.size();
     for(size_t i = 0; i<fieldsSize; i++) {
-        toPVFields[i]->copyUnchecked(*fromPVFields[i]);
+        PVField& to = *toPVFields[i];
+        const PVField& fr = *fromPVFields[i];
+        switch(to.getField()->getType()) {
+        case scalar:
+            // most common case, avoid PVField::copyUnchecked() dispatch
+            static_cast<PVScalar&>(to).copyUnchecked(static_cast<const PVScalar&>(fr));
+            break;
+        case structure:
+            static_cast<PVStructure&>(to).copyUnchecked(static_cast<const PVStructure&>(fr));
+            break;
+        default:
+            // arrays share storage
+            to.copyUnchecked(fr);
+        }
     }
 }
 
@@ -10,6 +10,7 @@
 #include <cstdlib>
 #include <string>
 #include <cstdio>
+#include <algorithm>
 
 #define epicsExportSharedSymbols
 #include <pv/pvData.h>
@@ -19,20 +20,296 @@
 using std::tr1::static_pointer_cast;
 using std::size_t;
 
+namespace {
+using namespace epics::pvData;
+
+// operations on one column of a columnar PVStructureArray
+struct ColumnOps {
+    void (*serialize)(const void *col, size_t row, ByteBuffer *pbuffer, SerializableControl *pflusher);
+    void (*deserialize)(void *col, size_t row, ByteBuffer *pbuffer, DeserializableControl *pcontrol);
+    // copy between element 'row' of a column and a PVScalar
+    void (*toField)(const void *col, size_t row, PVField& fld);
+    void (*fromField)(void *col, size_t row, const PVField& fld);
+};
+
+template<typename T>
+struct ColumnOpsT {
+    // as PVScalarValue<T>::serialize()
+    static void serialize(const void *col, size_t row, ByteBuffer *pbuffer, SerializableControl *pflusher)
+    {
+        pflusher->ensureBuffer(sizeof(T));
+        pbuffer->put(static_cast<const T*>(col)[row]);
+    }
+    static void deserialize(void *col, size_t row, ByteBuffer *pbuffer, DeserializableControl *pcontrol)
+    {
+        pcontrol->ensureData(sizeof(T));
+        static_cast<T*>(col)[row] = pbuffer->GET(T);
+    }
+    static void toField(const void *col, size_t row, PVField& fld)
+    {
+        static_cast<PVScalarValue<T>&>(fld).put(static_cast<const T*>(col)[row]);
+    }
+    static void fromField(void *col, size_t row, const PVField& fld)
+    {
+        static_cast<T*>(col)[row] = static_cast<const PVScalarValue<T>&>(fld).get();
+    }
+    static const ColumnOps ops;
+};
+
+template<typename T>
+const ColumnOps ColumnOpsT<T>::ops = {&serialize, &deserialize, &toField, &fromField};
+
+template<>
+void ColumnOpsT<std::string>::serialize(const void *col, size_t row, ByteBuffer *pbuffer, SerializableControl *pflusher)
+{
+    SerializeHelper::serializeString(static_cast<const std::string*>(col)[row], pbuffer, pflusher);
+}
+
+template<>
+void ColumnOpsT<std::string>::deserialize(void *col, size_t row, ByteBuffer *pbuffer, DeserializableControl *pcontrol)
+{
+    static_cast<std::string*>(col)[row] = SerializeHelper::deserializeString(pbuffer, pcontrol);
+}
+
+const ColumnOps& columnOps(ScalarType id)
+{
+    switch(id) {
+#define OP(ENUM, TYPE) case ENUM: return ColumnOpsT<TYPE>::ops
+    OP(pvBoolean, boolean);
+    OP(pvUByte, uint8);
+    OP(pvByte, int8);
+    OP(pvUShort, uint16);
+    OP(pvShort, int16);
+    OP(pvUInt, uint32);
+    OP(pvInt, int32);
+    OP(pvULong, uint64);
+    OP(pvLong, int64);
+    OP(pvFloat, float);
+    OP(pvDouble, double);
+    OP(pvString, std::string);
+#undef OP
+    default:
+        THROW_EXCEPTION2(std::invalid_argument, "error unknown ScalarType");
+    }
+}
+
+// Column types and operations for the fields of a Structure.
+struct ColumnTypes {
+    std::vector<ScalarType> types;
+    std::vector<const ColumnOps*> ops;
+
+    explicit ColumnTypes(const Structure& structure)
+    {
+        const FieldConstPtrArray& fields = structure.getFields();
+        types.resize(fields.size());
+        ops.resize(fields.size());
+        for(size_t i=0, N=fields.size(); i<N; i++) {
+            if(fields[i]->getType()!=scalar)
+                throw std::invalid_argument("columnar storage needs a Structure with only scalar fields");
+            types[i] = static_cast<const Scalar&>(*fields[i]).getScalarType();
+            ops[i] = &columnOps(types[i]);
+        }
+    }
+
+    size_t size() const { return types.size(); }
+};
+
+// Throw unless all non-NULL elements in [begin, end) have the array element type
+template<typename Iter>
+void checkElements(Iter begin, Iter end, const Structure& type)
+{
+    for(; begin!=end; ++begin) {
+        if(*begin && (*begin)->getStructure().get()!=&type && *(*begin)->getStructure()!=type)
+            throw std::invalid_argument("element does not match array element type");
+    }
+}
+
+} // namespace
+
 namespace epics { namespace pvData {
 
+void PVStructureArray::setColumnar(bool columnar)
+{
+    if(columnar==this->columnar)
+        return;
+
+    if(!columnar) {
+        const_svector next(buildRows());
+        dropColumns();
+        value = next;
+        return;
+    }
+
+    ColumnTypes info(*structureArray->getStructure());
+    const size_t nrows = value.size();
+
+    std::vector<shared_vector<void> > cols(info.size());
+    for(size_t c=0; c<info.size(); c++)
+        cols[c] = ScalarTypeFunc::allocArray(info.types[c], nrows);
+
+    for(size_t r=0; r<nrows; r++) {
+        if(!value[r])
+            throw std::invalid_argument("NULL element can not be stored as columns");
+        const PVFieldPtrArray& fields = value[r]->getPVFields();
+        for(size_t c=0; c<info.size(); c++)
+            info.ops[c]->fromField(cols[c].data(), r, *fields[c]);
+    }
+
+    columns_t next(info.size());
+    for(size_t c=0; c<info.size(); c++)
+        next[c] = freeze(cols[c]);
+
+    columns.swap(next);
+    rows = nrows;
+    value.clear();
+    this->columnar = true;
+}
+
+void PVStructureArray::putColumns(const columns_t& cols)
+{
+    ColumnTypes info(*structureArray->getStructure());
+
+    if(cols.size()!=info.size())
+        throw std::invalid_argument("number of columns does not match Structure");
+
+    size_t nrows = 0u;
+    for(size_t c=0; c<info.size(); c++) {
+        if(cols[c].original_type()!=info.types[c])
+            throw std::invalid_argument("column type does not match Structure");
+        const size_t n = cols[c].size()/ScalarTypeFunc::elementSize(info.types[c]);
+        if(c==0u)
+            nrows = n;
+        else if(n!=nrows)
+            throw std::invalid_argument("columns have different lengths");
+    }
+
+    checkLength(nrows);
+
+    columns = cols;
+    rows = nrows;
+    value.clear();
+    columnar = true;
+    PVField::postPut();
+}
+
+PVStructurePtr PVStructureArray::getRow(size_t index) const
+{
+    if(index>=getLength())
+        throw std::out_of_range("Index out of bounds");
+    else if(!columnar)
+        return std::tr1::const_pointer_cast<PVStructure>(value[index]);
+
+    ColumnTypes info(*structureArray->getStructure());
+    PVStructurePtr ret(getPVDataCreate()->createPVStructure(structureArray->getStructure()));
+    const PVFieldPtrArray& fields = ret->getPVFields();
+    for(size_t c=0; c<info.size(); c++)
+        info.ops[c]->toField(columns[c].data(), index, *fields[c]);
+    return ret;
+}
+
+PVStructureArray::const_svector PVStructureArray::buildRows() const
+{
+    ColumnTypes info(*structureArray->getStructure());
+    StructureConstPtr structure(structureArray->getStructure());
+    PVDataCreatePtr pvDataCreate(getPVDataCreate());
+
+    svector ret(rows);
+    for(size_t r=0; r<rows; r++) {
+        ret[r] = pvDataCreate->createPVStructure(structure);
+        const PVFieldPtrArray& fields = ret[r]->getPVFields();
+        for(size_t c=0; c<info.size(); c++)
+            info.ops[c]->toField(columns[c].data(), r, *fields[c]);
+    }
+    return freeze(ret);
+}
+
 size_t PVStructureArray::append(size_t number)
 {
-    checkLength(value.size()+number);
+    checkLength(getLength()+number);
+
+    svector data(reuse());
+    const size_t prev = data.size();
+    growTo(data, prev+number);
+
+    StructureConstPtr structure = structureArray->getStructure();
+
+    PVDataCreatePtr pvDataCreate = getPVDataCreate();
+    for(size_t i = prev; i<data.size(); i++)
+        data[i] = pvDataCreate->createPVStructure(structure);
+
+    size_t newLength = data.size();
+
+    const_svector cdata(freeze(data));
+    swap(cdata);
+
+    return newLength;
+}
+
+size_t PVStructureArray::append(const const_svector& elements)
+{
+    checkElements(elements.begin(), elements.end(), *structureArray->getStructure());
+    checkLength(getLength()+elements.size());
+
+    svector data(reuse());
+    const size_t prev = data.size();
+    growTo(data, prev+elements.size());
+
+    std::copy(elements.begin(), elements.end(), data.begin()+prev);
+
+    size_t newLength = data.size();
+
+    const_svector cdata(freeze(data));
+    swap(cdata);
+
+    return newLength;
+}
+
+size_t PVStructureArray::append(size_t number, const PVStructurePtr& prototype)
+{
+    StructureConstPtr structure = structureArray->getStructure();
+
+    if(!prototype || *prototype->getStructure() != *structure)
+        throw std::invalid_argument("prototype does not match array element type");
+
+    checkLength(getLength()+number);
+
+    svector data(reuse());
+    const size_t prev = data.size();
+    growTo(data, prev+number);
+
+    PVDataCreatePtr pvDataCreate = getPVDataCreate();
+    for(size_t i = prev; i<data.size(); i++)
+        data[i] = pvDataCreate->createPVStructure(prototype);
+
+    size_t newLength = data.size();
+
+    const_svector cdata(freeze(data));
+    swap(cdata);
+
+    return newLength;
+}
+
+size_t PVStructureArray::append(size_t number, svector& pool)
+{
+    // elements to be taken from the end of 'pool'
+    checkElements(pool.end()-std::min(number, pool.size()), pool.end(), *structureArray->getStructure());
+    checkLength(getLength()+number);
 
     svector data(reuse());
-    data.resize(data.size()+number);
+    const size_t prev = data.size();
+    growTo(data, prev+number);
 
     StructureConstPtr structure = structureArray->getStructure();
 
     PVDataCreatePtr pvDataCreate = getPVDataCreate();
-    for(svector::reverse_iterator it = data.rbegin(); number; ++it, --number)
-        *it = pvDataCreate->createPVStructure(structure);
+    for(size_t i = prev; i<data.size(); i++) {
+        if(!pool.empty()) {
+            data[i].swap(pool.back());
+            pool.pop_back();
+        }
+        if(!data[i])
+            data[i] = pvDataCreate->createPVStructure(structure);
+    }
 
     size_t newLength = data.size();
 
@@ -43,6 +320,26 @@ size_t PVStructureArray::append(size_t number)
 }
 
 bool PVStructureArray::remove(size_t offset,size_t number)
+{
+    return removeRange(offset, number, 0);
+}
+
+bool PVStructureArray::remove(size_t offset,size_t number, svector& pool)
+{
+    return removeRange(offset, number, &pool);
+}
+
+bool PVStructureArray::remove(const std::vector<size_t>& indices)
+{
+    return removeIndices(indices, 0);
+}
+
+bool PVStructureArray::remove(const std::vector<size_t>& indices, svector& pool)
+{
+    return removeIndices(indices, &pool);
+}
+
+bool PVStructureArray::removeRange(size_t offset,size_t number, svector *pool)
 {
     if (number==0)
         return true;
@@ -55,6 +352,10 @@ bool PVStructureArray::remove(size_t offset,size_t number)
 
     size_t length = vec.size();
 
+    for(size_t i = offset; i < offset+number; i++) {
+        toPool(pool, vec[i]);
+    }
+
     for(size_t i = offset; i+number < length; i++) {
          vec[i].swap(vec[i + number]);
     }
@@ -66,35 +367,61 @@ bool PVStructureArray::remove(size_t offset,size_t number)
     return true;
 }
 
+bool PVStructureArray::removeIndices(const std::vector<size_t>& indices, svector *pool)
+{
+    if (indices.empty())
+        return true;
+    else if (getArray()->getArraySizeType() == Array::fixed)
+        return false;
+
+    std::vector<size_t> sorted(indices);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    if (sorted.back()>=getLength())
+        return false;
+
+    svector vec(reuse());
+
+    size_t length = vec.size();
+    size_t newLength = sorted.front();
+
+    // single pass, keeping order
+    for(size_t i = sorted.front(), next = 0; i < length; i++) {
+        if(next<sorted.size() && sorted[next]==i) {
+            next++;
+            toPool(pool, vec[i]);
+        } else {
+            vec[newLength++].swap(vec[i]);
+        }
+    }
+
+    vec.resize(newLength);
+    const_svector cdata(freeze(vec));
+    swap(cdata);
+
+    return true;
+}
+
 void PVStructureArray::compress() {
-    if (getArray()->getArraySizeType() == Array::fixed)
+    if (getArray()->getArraySizeType() == Array::fixed || columnar)
             return;
 
-    svector vec(reuse()); // TODO: check for first NULL before realloc
+    {
+        const_svector temp(view());
+        if(std::find(temp.begin(), temp.end(), PVStructurePtr())==temp.end())
+            return; // no NULL elements
+    }
+
+    svector vec(reuse());
 
     size_t length = vec.size();
     size_t newLength = 0;
 
+    // single pass, keeping order
     for(size_t i=0; i<length; i++) {
-        if(vec[i]) {
-            newLength++;
-            continue;
-        }
-        // find first non 0
-        size_t notNull = 0;
-        for(size_t j=i+1;j<length;j++) {
-            if(vec[j]) {
-                notNull = j;
-                break;
-            }
-        }
-        if(notNull!=0) {
-            vec[i] = vec[notNull];
-            vec[notNull].reset();
-            newLength++;
-            continue;
-         }
-         break;
+        if(vec[i])
+            vec[newLength++].swap(vec[i]);
     }
 
     vec.resize(newLength);
@@ -148,6 +475,11 @@ void PVStructureArray::swap(const_svector &other)
 
     // no checkLength call here
 
+    if(columnar) {
+        const_svector next(buildRows());
+        dropColumns();
+        value = next;
+    }
     value.swap(other);
 }
 
@@ -158,19 +490,56 @@ void PVStructureArray::serialize(ByteBuffer *pbuffer,
 
 void PVStructureArray::deserialize(ByteBuffer *pbuffer,
         DeserializableControl *pcontrol) {
-    svector data(reuse());
-
     size_t size = this->getArray()->getArraySizeType() == Array::fixed ?
                 this->getArray()->getMaximumCapacity() :
                 SerializeHelper::readSize(pbuffer, pcontrol);
 
+    svector data;
+    size_t i = 0;
+
+    if(columnar) {
+        ColumnTypes info(*structureArray->getStructure());
+
+        std::vector<shared_vector<void> > cols(info.size());
+        for(size_t c=0; c<info.size(); c++)
+            cols[c] = ScalarTypeFunc::allocArray(info.types[c], size);
+
+        for(; i<size; i++) {
+            pcontrol->ensureData(1);
+            if(pbuffer->getByte(pbuffer->getPosition())==0)
+                break; // NULL element can not be stored as columns
+            pbuffer->getByte();
+            for(size_t c=0; c<info.size(); c++)
+                info.ops[c]->deserialize(cols[c].data(), i, pbuffer, pcontrol);
+        }
+
+        columns_t next(info.size());
+        for(size_t c=0; c<info.size(); c++)
+            next[c] = freeze(cols[c]);
+        columns.swap(next);
+        rows = i;
+
+        if(i==size) {
+            PVField::postPut();
+            return;
+        }
+
+        // continue as PVStructure s
+        const_svector prev(buildRows());
+        dropColumns();
+        data = thaw(prev);
+
+    } else {
+        data = reuse();
+    }
+
     data.resize(size);
 
     StructureConstPtr structure = structureArray->getStructure();
 
     PVDataCreatePtr pvDataCreate = getPVDataCreate();
 
-    for(size_t i = 0; i<size; i++) {
+    for(; i<size; i++) {
         pcontrol->ensureData(1);
         size_t temp = pbuffer->getByte();
         if(temp==0) {
@@ -189,6 +558,31 @@ void PVStructureArray::deserialize(ByteBuffer *pbuffer,
 void PVStructureArray::serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher, size_t offset, size_t count) const {
 
+    if(columnar) {
+        if(offset > rows)
+            offset = rows;
+        if(count > rows-offset)
+            count = rows-offset;
+
+        ArrayConstPtr array = this->getArray();
+        if (array->getArraySizeType() != Array::fixed)
+            SerializeHelper::writeSize(count, pbuffer, pflusher);
+        else if (count != array->getMaximumCapacity())
+            throw std::length_error("fixed array cannot be partially serialized");
+
+        ColumnTypes info(*structureArray->getStructure());
+
+        for(size_t r = offset; r<offset+count; r++) {
+            if(pbuffer->getRemaining()<1)
+                pflusher->flushSerializeBuffer();
+
+            pbuffer->putByte(1);
+            for(size_t c=0; c<info.size(); c++)
+                info.ops[c]->serialize(columns[c].data(), r, pbuffer, pflusher);
+        }
+        return;
+    }
+
     const_svector temp(view());
     temp.slice(offset, count);
 
@@ -229,6 +623,11 @@ std::ostream& PVStructureArray::dumpValue(std::ostream& o) const
 
 std::ostream& PVStructureArray::dumpValue(std::ostream& o, std::size_t index) const
 {
+    if(columnar) {
+        if(index<rows)
+            o << *getRow(index);
+        return o;
+    }
     const_svector temp(view());
     if (index<temp.size())
     {
@@ -256,7 +655,10 @@ void PVStructureArray::copyUnchecked(const PVStructureArray& from)
     if (this == &from)
         return;
 
-    replace(from.view());
+    if(from.columnar)
+        putColumns(from.columns);
+    else
+        replace(from.view());
 }
 
 }}
@@ -10,6 +10,7 @@
 #include <cstdlib>
 #include <string>
 #include <cstdio>
+#include <algorithm>
 
 #define epicsExportSharedSymbols
 #include <pv/pvData.h>
@@ -19,20 +20,110 @@
 using std::tr1::static_pointer_cast;
 using std::size_t;
 
+namespace {
+using namespace epics::pvData;
+
+// Throw unless all non-NULL elements in [begin, end) have the array element type
+template<typename Iter>
+void checkElements(Iter begin, Iter end, const Union& type)
+{
+    for(; begin!=end; ++begin) {
+        if(*begin && (*begin)->getUnion().get()!=&type && *(*begin)->getUnion()!=type)
+            throw std::invalid_argument("element does not match array element type");
+    }
+}
+
+} // namespace
+
 namespace epics { namespace pvData {
 
 size_t PVUnionArray::append(size_t number)
 {
-    checkLength(value.size()+number);
+    checkLength(getLength()+number);
+
+    svector data(reuse());
+    const size_t prev = data.size();
+    growTo(data, prev+number);
+
+    UnionConstPtr punion = unionArray->getUnion();
+
+    PVDataCreatePtr pvDataCreate = getPVDataCreate();
+    for(size_t i = prev; i<data.size(); i++)
+        data[i] = pvDataCreate->createPVUnion(punion);
+
+    size_t newLength = data.size();
+
+    const_svector cdata(freeze(data));
+    swap(cdata);
+
+    return newLength;
+}
+
+size_t PVUnionArray::append(const const_svector& elements)
+{
+    checkElements(elements.begin(), elements.end(), *unionArray->getUnion());
+    checkLength(getLength()+elements.size());
+
+    svector data(reuse());
+    const size_t prev = data.size();
+    growTo(data, prev+elements.size());
+
+    std::copy(elements.begin(), elements.end(), data.begin()+prev);
+
+    size_t newLength = data.size();
+
+    const_svector cdata(freeze(data));
+    swap(cdata);
+
+    return newLength;
+}
+
+size_t PVUnionArray::append(size_t number, const PVUnionPtr& prototype)
+{
+    UnionConstPtr punion = unionArray->getUnion();
+
+    if(!prototype || *prototype->getUnion() != *punion)
+        throw std::invalid_argument("prototype does not match array element type");
+
+    checkLength(getLength()+number);
+
+    svector data(reuse());
+    const size_t prev = data.size();
+    growTo(data, prev+number);
+
+    PVDataCreatePtr pvDataCreate = getPVDataCreate();
+    for(size_t i = prev; i<data.size(); i++)
+        data[i] = pvDataCreate->createPVUnion(prototype);
+
+    size_t newLength = data.size();
+
+    const_svector cdata(freeze(data));
+    swap(cdata);
+
+    return newLength;
+}
+
+size_t PVUnionArray::append(size_t number, svector& pool)
+{
+    // elements to be taken from the end of 'pool'
+    checkElements(pool.end()-std::min(number, pool.size()), pool.end(), *unionArray->getUnion());
+    checkLength(getLength()+number);
 
     svector data(reuse());
-    data.resize(data.size()+number);
+    const size_t prev = data.size();
+    growTo(data, prev+number);
 
     UnionConstPtr punion = unionArray->getUnion();
 
     PVDataCreatePtr pvDataCreate = getPVDataCreate();
-    for(svector::reverse_iterator it = data.rbegin(); number; ++it, --number)
-        *it = pvDataCreate->createPVUnion(punion);
+    for(size_t i = prev; i<data.size(); i++) {
+        if(!pool.empty()) {
+            data[i].swap(pool.back());
+            pool.pop_back();
+        }
+        if(!data[i])
+            data[i] = pvDataCreate->createPVUnion(punion);
+    }
 
     size_t newLength = data.size();
 
@@ -43,6 +134,26 @@ size_t PVUnionArray::append(size_t number)
 }
 
 bool PVUnionArray::remove(size_t offset,size_t number)
+{
+    return removeRange(offset, number, 0);
+}
+
+bool PVUnionArray::remove(size_t offset,size_t number, svector& pool)
+{
+    return removeRange(offset, number, &pool);
+}
+
+bool PVUnionArray::remove(const std::vector<size_t>& indices)
+{
+    return removeIndices(indices, 0);
+}
+
+bool PVUnionArray::remove(const std::vector<size_t>& indices, svector& pool)
+{
+    return removeIndices(indices, &pool);
+}
+
+bool PVUnionArray::removeRange(size_t offset,size_t number, svector *pool)
 {
     if (number==0)
         return true;
@@ -55,6 +166,10 @@ bool PVUnionArray::remove(size_t offset,size_t number)
 
     size_t length = vec.size();
 
+    for(size_t i = offset; i < offset+number; i++) {
+        toPool(pool, vec[i]);
+    }
+
     for(size_t i = offset; i+number < length; i++) {
          vec[i].swap(vec[i + number]);
     }
@@ -66,35 +181,61 @@ bool PVUnionArray::remove(size_t offset,size_t number)
     return true;
 }
 
+bool PVUnionArray::removeIndices(const std::vector<size_t>& indices, svector *pool)
+{
+    if (indices.empty())
+        return true;
+    else if (getArray()->getArraySizeType() == Array::fixed)
+        return false;
+
+    std::vector<size_t> sorted(indices);
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+
+    if (sorted.back()>=getLength())
+        return false;
+
+    svector vec(reuse());
+
+    size_t length = vec.size();
+    size_t newLength = sorted.front();
+
+    // single pass, keeping order
+    for(size_t i = sorted.front(), next = 0; i < length; i++) {
+        if(next<sorted.size() && sorted[next]==i) {
+            next++;
+            toPool(pool, vec[i]);
+        } else {
+            vec[newLength++].swap(vec[i]);
+        }
+    }
+
+    vec.resize(newLength);
+    const_svector cdata(freeze(vec));
+    swap(cdata);
+
+    return true;
+}
+
 void PVUnionArray::compress() {
     if (getArray()->getArraySizeType() == Array::fixed)
             return;
 
-    svector vec(reuse()); // TODO: check for first NULL before realloc
+    {
+        const_svector temp(view());
+        if(std::find(temp.begin(), temp.end(), PVUnionPtr())==temp.end())
+            return; // no NULL elements
+    }
+
+    svector vec(reuse());
 
     size_t length = vec.size();
     size_t newLength = 0;
 
+    // single pass, keeping order
     for(size_t i=0; i<length; i++) {
-        if(vec[i]) {
-            newLength++;
-            continue;
-        }
-        // find first non 0
-        size_t notNull = 0;
-        for(size_t j=i+1;j<length;j++) {
-            if(vec[j]) {
-                notNull = j;
-                break;
-            }
-        }
-        if(notNull!=0) {
-            vec[i] = vec[notNull];
-            vec[notNull].reset();
-            newLength++;
-            continue;
-         }
-         break;
+        if(vec[i])
+            vec[newLength++].swap(vec[i]);
     }
 
     vec.resize(newLength);
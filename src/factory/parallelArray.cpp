@@ -0,0 +1,263 @@
+/* parallelArray.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+
+#define epicsExportSharedSymbols
+#include <pv/pvData.h>
+#include <pv/byteBuffer.h>
+#include <pv/serialize.h>
+#include <pv/serializeHelper.h>
+#include <pv/parallelArray.h>
+
+namespace {
+using namespace epics::pvData;
+
+// Element type, and element creation, for each array type
+template<typename A> struct ElementType;
+template<> struct ElementType<PVStructureArray> { typedef StructureConstPtr type; };
+template<> struct ElementType<PVUnionArray> { typedef UnionConstPtr type; };
+
+inline StructureConstPtr elementType(const PVStructureArray& arr) { return arr.getStructureArray()->getStructure(); }
+inline UnionConstPtr elementType(const PVUnionArray& arr) { return arr.getUnionArray()->getUnion(); }
+
+inline PVStructurePtr createElement(const StructureConstPtr& type) { return getPVDataCreate()->createPVStructure(type); }
+inline PVUnionPtr createElement(const UnionConstPtr& type) { return getPVDataCreate()->createPVUnion(type); }
+
+inline ParallelExecutor* pickExecutor(ParallelExecutor *exec)
+{
+    return exec ? exec : ParallelExecutor::getDefault().get();
+}
+
+// Split [0, count) into parts of at least parallelMinElements,
+// with a few parts per thread to balance uneven elements.
+struct Partition {
+    size_t count, partSize, nparts;
+
+    Partition(size_t count, ParallelExecutor *exec)
+        :count(count)
+    {
+        size_t target = exec->concurrency()*4u;
+        partSize = std::max(parallelMinElements, (count+target-1u)/target);
+        nparts = (count+partSize-1u)/partSize;
+    }
+
+    inline size_t begin(size_t part) const { return part*partSize; }
+    inline size_t end(size_t part) const { return std::min(count, (part+1u)*partSize); }
+};
+
+template<typename A>
+struct CopyWork : public ParallelWork {
+    const Partition& P;
+    const typename A::const_svector& src;
+    typename A::svector& dest;
+    const typename ElementType<A>::type type;
+
+    CopyWork(const Partition& P, const typename A::const_svector& src, typename A::svector& dest, const A& arr)
+        :P(P), src(src), dest(dest), type(elementType(arr)) {}
+    virtual ~CopyWork() {}
+
+    virtual void run(size_t part) OVERRIDE FINAL
+    {
+        for(size_t i=P.begin(part), end=P.end(part); i<end; i++) {
+            if(src[i]) { // NULL elements remain NULL
+                dest[i] = createElement(type);
+                dest[i]->copyUnchecked(*src[i]);
+            }
+        }
+    }
+};
+
+template<typename A>
+void copyArray(A& dest, const A& src, ParallelExecutor *exec)
+{
+    if(*elementType(dest)!=*elementType(src))
+        throw std::invalid_argument("copyElements() requires arrays of the same element type");
+
+    typename A::const_svector from(src.view());
+    typename A::svector to(from.size());
+
+    if(!from.empty()) {
+        exec = pickExecutor(exec);
+        Partition P(from.size(), exec);
+        CopyWork<A> work(P, from, to, src);
+        exec->execute(P.nparts, work);
+    }
+
+    dest.replace(freeze(to));
+}
+
+template<typename A>
+struct EqualWork : public ParallelWork {
+    const Partition& P;
+    const typename A::const_svector& a;
+    const typename A::const_svector& b;
+    // one flag per part, so no locking is needed
+    std::vector<char> differ;
+
+    EqualWork(const Partition& P, const typename A::const_svector& a, const typename A::const_svector& b)
+        :P(P), a(a), b(b), differ(P.nparts, 0) {}
+    virtual ~EqualWork() {}
+
+    virtual void run(size_t part) OVERRIDE FINAL
+    {
+        for(size_t i=P.begin(part), end=P.end(part); i<end; i++) {
+            // element can be null
+            if(!a[i] || !b[i]) {
+                if(a[i] || b[i]) {
+                    differ[part] = 1;
+                    return;
+                }
+            } else if(*a[i] != *b[i]) {
+                differ[part] = 1;
+                return;
+            }
+        }
+    }
+};
+
+template<typename A>
+bool equalArray(const A& left, const A& right, ParallelExecutor *exec)
+{
+    if(&left==&right)
+        return true;
+    else if(*left.getField()!=*right.getField())
+        return false;
+
+    typename A::const_svector a(left.view()), b(right.view());
+
+    if(a.size()!=b.size())
+        return false;
+    else if(a.data()==b.data())
+        return true; // shared storage
+
+    exec = pickExecutor(exec);
+    Partition P(a.size(), exec);
+    EqualWork<A> work(P, a, b);
+    exec->execute(P.nparts, work);
+
+    return std::find(work.differ.begin(), work.differ.end(), 1)==work.differ.end();
+}
+
+// Counts, rather than stores, serialized bytes.
+struct CountingControl : public SerializableControl {
+    ByteBuffer buffer;
+    size_t count;
+
+    CountingControl() :buffer(16*1024), count(0u) {}
+    virtual ~CountingControl() {}
+
+    virtual void flushSerializeBuffer() OVERRIDE FINAL
+    {
+        count += buffer.getPosition();
+        buffer.clear();
+    }
+    virtual void ensureBuffer(std::size_t size) OVERRIDE FINAL
+    {
+        if(buffer.getRemaining()<size)
+            flushSerializeBuffer();
+    }
+    virtual void alignBuffer(std::size_t) OVERRIDE FINAL {}
+    virtual bool directSerialize(ByteBuffer *, const char*, std::size_t elementCount, std::size_t elementSize) OVERRIDE FINAL
+    {
+        count += elementCount*elementSize;
+        return true;
+    }
+    virtual void cachedSerialize(std::tr1::shared_ptr<const Field> const & field, ByteBuffer* pbuffer) OVERRIDE FINAL
+    {
+        field->serialize(pbuffer, this);
+    }
+
+    size_t total()
+    {
+        flushSerializeBuffer();
+        return count;
+    }
+};
+
+template<typename A>
+struct SizeWork : public ParallelWork {
+    const Partition& P;
+    const typename A::const_svector& elements;
+    std::vector<size_t> sizes; // per part
+
+    SizeWork(const Partition& P, const typename A::const_svector& elements)
+        :P(P), elements(elements), sizes(P.nparts, 0u) {}
+    virtual ~SizeWork() {}
+
+    virtual void run(size_t part) OVERRIDE FINAL
+    {
+        CountingControl C;
+        for(size_t i=P.begin(part), end=P.end(part); i<end; i++) {
+            C.ensureBuffer(1);
+            C.buffer.putByte(elements[i] ? 1 : 0); // NULL flag
+            if(elements[i])
+                elements[i]->serialize(&C.buffer, &C);
+        }
+        sizes[part] = C.total();
+    }
+};
+
+// mirrors PVStructureArray::serialize() and PVUnionArray::serialize()
+template<typename A>
+size_t sizeArray(const A& arr, ParallelExecutor *exec)
+{
+    typename A::const_svector elements(arr.view());
+
+    size_t total = 0u;
+    if(arr.getArray()->getArraySizeType() != Array::fixed)
+        total += elements.size()<254u ? 1u : 5u; // see SerializeHelper::writeSize()
+
+    if(!elements.empty()) {
+        exec = pickExecutor(exec);
+        Partition P(elements.size(), exec);
+        SizeWork<A> work(P, elements);
+        exec->execute(P.nparts, work);
+
+        for(size_t i=0; i<work.sizes.size(); i++)
+            total += work.sizes[i];
+    }
+    return total;
+}
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+const size_t parallelMinElements = 256u;
+
+void copyElements(PVStructureArray& dest, const PVStructureArray& src, ParallelExecutor* executor)
+{
+    copyArray(dest, src, executor);
+}
+
+void copyElements(PVUnionArray& dest, const PVUnionArray& src, ParallelExecutor* executor)
+{
+    copyArray(dest, src, executor);
+}
+
+bool equalElements(const PVStructureArray& a, const PVStructureArray& b, ParallelExecutor* executor)
+{
+    return equalArray(a, b, executor);
+}
+
+bool equalElements(const PVUnionArray& a, const PVUnionArray& b, ParallelExecutor* executor)
+{
+    return equalArray(a, b, executor);
+}
+
+size_t serializedSize(const PVStructureArray& value, ParallelExecutor* executor)
+{
+    return sizeArray(value, executor);
+}
+
+size_t serializedSize(const PVUnionArray& value, ParallelExecutor* executor)
+{
+    return sizeArray(value, executor);
+}
+
+}} // namespace epics::pvData
@@ -0,0 +1,630 @@
+/* pvDataFile.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <string>
+#include <sstream>
+#include <vector>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_WIN32)
+#  define PVD_FILE_WIN32
+#  include <windows.h>
+#elif (defined(__unix__) || defined(__APPLE__)) && !defined(__rtems__) && !defined(vxWorks)
+#  define PVD_FILE_MMAP
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <sys/mman.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <epicsEndian.h>
+
+#define epicsExportSharedSymbols
+#include <pv/sharedPtr.h>
+#include <pv/byteBuffer.h>
+#include <pv/serialize.h>
+#include <pv/pvData.h>
+#include <pv/pvDataFile.h>
+
+namespace {
+using namespace epics::pvData;
+
+/* File layout
+ *
+ *  0  char[4] magic "PVDF"
+ *  4  uint8   format version (1)
+ *  5  uint8   byte order (0 - little, 1 - big)
+ *  6  uint16  reserved (0)
+ *  8  uint32  size of serialized introspection
+ * 12  ...     serialized introspection
+ *     ...     values (see FileWriter::saveValue())
+ */
+const char fileMagic[4] = {'P', 'V', 'D', 'F'};
+const uint8 fileVersion = 1;
+// primitive array elements begin on this boundary
+const size_t arrayAlign = 16;
+
+std::string errorString(const std::string& msg, const std::string& path)
+{
+    std::string ret(msg);
+    ret += " '";
+    ret += path;
+    ret += "' : ";
+    ret += strerror(errno);
+    return ret;
+}
+
+/* Written to a temporary file in the same directory, which then replaces the target.
+ * So arrays of a previous loadFromFile() of the target, which reference the old file,
+ * remain valid, and the target is unchanged on error.
+ */
+struct FileWriter {
+    FILE *fp;
+    const std::string& path;
+    std::string temp;
+    size_t pos;
+
+    FileWriter(const std::string& path)
+        :fp(0)
+        ,path(path)
+        ,pos(0)
+    {
+#ifdef PVD_FILE_MMAP
+        // unique name.  permissions as for fopen()
+        for(unsigned n=0; !fp; n++) {
+            std::ostringstream strm;
+            strm<<path<<".tmp"<<getpid()<<"_"<<n;
+            temp = strm.str();
+            int fd = open(temp.c_str(), O_WRONLY|O_CREAT|O_EXCL, 0666);
+            if(fd<0 && errno==EEXIST)
+                continue;
+            else if(fd<0)
+                break;
+            fp = fdopen(fd, "wb");
+            if(!fp) {
+                std::string msg(errorString("Unable to create", temp));
+                ::close(fd);
+                remove(temp.c_str());
+                throw std::runtime_error(msg);
+            }
+        }
+#else
+        temp = path + ".tmp";
+        fp = fopen(temp.c_str(), "wb");
+#endif
+        if(!fp)
+            throw std::runtime_error(errorString("Unable to create", temp));
+    }
+    ~FileWriter() {
+        if(fp) {
+            fclose(fp);
+            remove(temp.c_str());
+        }
+    }
+
+    void close() {
+        int err = fflush(fp);
+#ifdef PVD_FILE_MMAP
+        if(!err)
+            err = fsync(fileno(fp));
+#endif
+        err |= fclose(fp);
+        fp = 0;
+        if(err) {
+            std::string msg(errorString("Error writing", temp));
+            remove(temp.c_str());
+            throw std::runtime_error(msg);
+        }
+#ifdef PVD_FILE_WIN32
+        if(!MoveFileExA(temp.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING|MOVEFILE_WRITE_THROUGH)) {
+#else
+        if(rename(temp.c_str(), path.c_str())!=0) {
+#endif
+            std::string msg(errorString("Unable to replace", path));
+            remove(temp.c_str());
+            throw std::runtime_error(msg);
+        }
+    }
+
+    void write(const void *buf, size_t n) {
+        if(n && fwrite(buf, 1, n, fp)!=n)
+            throw std::runtime_error(errorString("Error writing", path));
+        pos += n;
+    }
+
+    void align(size_t n) {
+        static const char zeros[arrayAlign] = {};
+        write(zeros, (n - pos%n)%n);
+    }
+
+    template<typename T>
+    void put(T val) {
+        align(sizeof(T));
+        write(&val, sizeof(T));
+    }
+
+    void putString(const std::string& val) {
+        put<uint32>(val.size());
+        write(val.c_str(), val.size());
+    }
+
+    void putType(const FieldConstPtr& type) {
+        std::vector<epicsUInt8> bytes;
+        serializeToVector(type.get(), EPICS_BYTE_ORDER, bytes);
+        put<uint32>(bytes.size());
+        write(&bytes[0], bytes.size());
+    }
+
+    template<typename T>
+    void saveScalar(const PVScalar& pv) {
+        put<T>(static_cast<const PVScalarValue<T>&>(pv).get());
+    }
+
+    template<typename T>
+    void saveArray(const PVScalarArray& pv) {
+        typename PVValueArray<T>::const_svector arr(static_cast<const PVValueArray<T>&>(pv).view());
+        put<uint64>(arr.size());
+        align(arrayAlign);
+        write(arr.data(), arr.size()*sizeof(T));
+    }
+
+    void saveValue(const PVField& pv);
+
+    void saveStructure(const PVStructure& pv) {
+        const PVFieldPtrArray& fields = pv.getPVFields();
+        for(size_t i=0, N=fields.size(); i<N; i++)
+            saveValue(*fields[i]);
+    }
+
+    void saveUnion(const PVUnion& pv) {
+        if(pv.getUnion()->isVariant()) {
+            PVField::const_shared_pointer val(pv.get());
+            put<uint8>(val ? 1 : 0);
+            if(val) {
+                putType(val->getField());
+                saveValue(*val);
+            }
+        } else {
+            put<int32>(pv.getSelectedIndex());
+            if(pv.getSelectedIndex()!=PVUnion::UNDEFINED_INDEX)
+                saveValue(*pv.get());
+        }
+    }
+};
+
+void FileWriter::saveValue(const PVField& pv)
+{
+    switch(pv.getField()->getType()) {
+    case scalar: {
+        const PVScalar& S = static_cast<const PVScalar&>(pv);
+        switch(S.getScalar()->getScalarType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv##PVACODE: saveScalar<PVATYPE>(S); return;
+#define CASE_REAL_INT64
+#include <pv/typemap.h>
+#undef CASE_REAL_INT64
+#undef CASE
+        case pvString: putString(static_cast<const PVString&>(S).get()); return;
+        }
+        break;
+    }
+    case scalarArray: {
+        const PVScalarArray& A = static_cast<const PVScalarArray&>(pv);
+        switch(A.getScalarArray()->getElementType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv##PVACODE: saveArray<PVATYPE>(A); return;
+#define CASE_REAL_INT64
+#include <pv/typemap.h>
+#undef CASE_REAL_INT64
+#undef CASE
+        case pvString: {
+            PVStringArray::const_svector arr(static_cast<const PVStringArray&>(A).view());
+            put<uint64>(arr.size());
+            for(size_t i=0, N=arr.size(); i<N; i++)
+                putString(arr[i]);
+            return;
+        }
+        }
+        break;
+    }
+    case structure:
+        saveStructure(static_cast<const PVStructure&>(pv));
+        return;
+    case structureArray: {
+        PVStructureArray::const_svector arr(static_cast<const PVStructureArray&>(pv).view());
+        put<uint64>(arr.size());
+        for(size_t i=0, N=arr.size(); i<N; i++) {
+            put<uint8>(arr[i] ? 1 : 0);
+            if(arr[i])
+                saveStructure(*arr[i]);
+        }
+        return;
+    }
+    case union_:
+        saveUnion(static_cast<const PVUnion&>(pv));
+        return;
+    case unionArray: {
+        PVUnionArray::const_svector arr(static_cast<const PVUnionArray&>(pv).view());
+        put<uint64>(arr.size());
+        for(size_t i=0, N=arr.size(); i<N; i++) {
+            put<uint8>(arr[i] ? 1 : 0);
+            if(arr[i])
+                saveUnion(*arr[i]);
+        }
+        return;
+    }
+    }
+    THROW_EXCEPTION2(std::logic_error, "saveToFile: unknown field type");
+}
+
+/* Holds the file contents in memory.  Either a copy on write mapping,
+ * or a heap buffer where mapping is not available.
+ */
+struct FileMapping {
+    POINTER_DEFINITIONS(FileMapping);
+
+    char *base;
+    size_t size;
+#if defined(PVD_FILE_WIN32)
+    HANDLE hfile, hmap;
+#elif !defined(PVD_FILE_MMAP)
+    std::vector<double> storage; // double for alignment
+#endif
+
+    explicit FileMapping(const std::string& path);
+    ~FileMapping();
+
+    EPICS_NOT_COPYABLE(FileMapping)
+};
+
+#if defined(PVD_FILE_MMAP)
+
+FileMapping::FileMapping(const std::string& path)
+    :base(0)
+    ,size(0)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd<0)
+        throw std::runtime_error(errorString("Unable to open", path));
+    struct stat info;
+    if(fstat(fd, &info)) {
+        std::string msg(errorString("Unable to stat", path));
+        ::close(fd);
+        throw std::runtime_error(msg);
+    }
+    size = info.st_size;
+    if(size==0) {
+        ::close(fd);
+        throw std::runtime_error("Empty file '"+path+"'");
+    }
+    // private (copy on write) mapping so that thaw() of a unique array
+    // may modify in place without altering the file.
+    void *addr = mmap(0, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if(addr==MAP_FAILED) {
+        std::string msg(errorString("Unable to map", path));
+        ::close(fd);
+        throw std::runtime_error(msg);
+    }
+    ::close(fd);
+    base = (char*)addr;
+}
+
+FileMapping::~FileMapping()
+{
+    munmap(base, size);
+}
+
+#elif defined(PVD_FILE_WIN32)
+
+FileMapping::FileMapping(const std::string& path)
+    :base(0)
+    ,size(0)
+    ,hfile(INVALID_HANDLE_VALUE)
+    ,hmap(NULL)
+{
+    hfile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(hfile==INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Unable to open '"+path+"'");
+    LARGE_INTEGER fsize;
+    if(!GetFileSizeEx(hfile, &fsize) || fsize.QuadPart==0
+            || !(hmap = CreateFileMappingA(hfile, NULL, PAGE_WRITECOPY, 0, 0, NULL))
+            || !(base = (char*)MapViewOfFile(hmap, FILE_MAP_COPY, 0, 0, 0)))
+    {
+        if(hmap) CloseHandle(hmap);
+        CloseHandle(hfile);
+        throw std::runtime_error("Unable to map '"+path+"'");
+    }
+    size = size_t(fsize.QuadPart);
+}
+
+FileMapping::~FileMapping()
+{
+    UnmapViewOfFile(base);
+    CloseHandle(hmap);
+    CloseHandle(hfile);
+}
+
+#else
+
+FileMapping::FileMapping(const std::string& path)
+    :base(0)
+    ,size(0)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    if(!fp)
+        throw std::runtime_error(errorString("Unable to open", path));
+    bool ok = fseek(fp, 0, SEEK_END)==0;
+    long fsize = ok ? ftell(fp) : -1;
+    ok = fsize>0 && fseek(fp, 0, SEEK_SET)==0;
+    if(ok) {
+        size = size_t(fsize);
+        storage.resize((size+sizeof(double)-1)/sizeof(double));
+        base = (char*)&storage[0];
+        ok = fread(base, 1, size, fp)==size;
+    }
+    std::string msg(errorString("Unable to read", path));
+    fclose(fp);
+    if(!ok)
+        throw std::runtime_error(msg);
+}
+
+FileMapping::~FileMapping() {}
+
+#endif
+
+// shared_ptr "deleter" which keeps the mapping alive
+struct MappingRef {
+    FileMapping::shared_pointer mapping;
+    explicit MappingRef(const FileMapping::shared_pointer& mapping) :mapping(mapping) {}
+    void operator()(const void*) { mapping.reset(); }
+};
+
+struct FileControl : public DeserializableControl {
+    ByteBuffer& buf;
+    FieldCreatePtr create;
+    explicit FileControl(ByteBuffer& buf) :buf(buf), create(getFieldCreate()) {}
+    virtual ~FileControl() {}
+
+    virtual void ensureData(std::size_t size) OVERRIDE FINAL {
+        if(size>buf.getRemaining())
+            throw std::runtime_error("loadFromFile: Truncated type");
+    }
+    virtual void alignData(std::size_t alignment) OVERRIDE FINAL {}
+    virtual bool directDeserialize(ByteBuffer *existingBuffer, char* deserializeTo,
+                                   std::size_t elementCount, std::size_t elementSize) OVERRIDE FINAL
+    {
+        return false;
+    }
+    virtual std::tr1::shared_ptr<const Field> cachedDeserialize(ByteBuffer* buffer) OVERRIDE FINAL
+    {
+        return create->deserialize(buffer, this);
+    }
+};
+
+struct FileReader {
+    FileMapping::shared_pointer mapping;
+    const int byteOrder;
+    ByteBuffer buf;
+    PVDataCreatePtr create;
+
+    FileReader(const FileMapping::shared_pointer& mapping, int byteOrder)
+        :mapping(mapping)
+        ,byteOrder(byteOrder)
+        ,buf(mapping->base, mapping->size, byteOrder)
+        ,create(getPVDataCreate())
+    {}
+
+    void need(size_t n) {
+        if(buf.getRemaining()<n)
+            throw std::runtime_error("loadFromFile: Truncated file");
+    }
+
+    void align(size_t n) {
+        size_t pad = (n - buf.getPosition()%n)%n;
+        need(pad);
+        buf.setPosition(buf.getPosition()+pad);
+    }
+
+    template<typename T>
+    T get() {
+        align(sizeof(T));
+        need(sizeof(T));
+        return buf.get<T>();
+    }
+
+    size_t getCount(size_t minsize) {
+        uint64 count = get<uint64>();
+        if(count > buf.getRemaining()/minsize)
+            throw std::runtime_error("loadFromFile: Truncated file");
+        return size_t(count);
+    }
+
+    std::string getString() {
+        uint32 len = get<uint32>();
+        need(len);
+        std::string ret(buf.getBuffer()+buf.getPosition(), len);
+        buf.setPosition(buf.getPosition()+len);
+        return ret;
+    }
+
+    FieldConstPtr getType() {
+        uint32 len = get<uint32>();
+        need(len);
+        ByteBuffer tbuf(mapping->base+buf.getPosition(), len, byteOrder);
+        FileControl control(tbuf);
+        FieldConstPtr ret(control.cachedDeserialize(&tbuf));
+        if(!ret || tbuf.getRemaining()!=0)
+            throw std::runtime_error("loadFromFile: Invalid type");
+        buf.setPosition(buf.getPosition()+len);
+        return ret;
+    }
+
+    template<typename T>
+    void loadScalar(PVScalar& pv) {
+        static_cast<PVScalarValue<T>&>(pv).put(get<T>());
+    }
+
+    template<typename T>
+    void loadArray(PVScalarArray& pv) {
+        size_t count = getCount(sizeof(T)); // may also include padding
+        align(arrayAlign);
+        need(count*sizeof(T));
+
+        typename PVValueArray<T>::const_svector arr;
+        if(!buf.reverse<T>()) {
+            // refer to the mapping in place
+            const T *start = reinterpret_cast<const T*>(buf.getBuffer()+buf.getPosition());
+            typename PVValueArray<T>::const_svector temp(start, MappingRef(mapping), 0, count);
+            arr.swap(temp);
+            buf.setPosition(buf.getPosition()+count*sizeof(T));
+        } else {
+            typename PVValueArray<T>::svector temp(count);
+            buf.getArray(temp.data(), count);
+            arr = freeze(temp);
+        }
+        static_cast<PVValueArray<T>&>(pv).replace(arr);
+    }
+
+    void loadValue(PVField& pv);
+
+    void loadStructure(PVStructure& pv) {
+        const PVFieldPtrArray& fields = pv.getPVFields();
+        for(size_t i=0, N=fields.size(); i<N; i++)
+            loadValue(*fields[i]);
+    }
+
+    void loadUnion(PVUnion& pv) {
+        if(pv.getUnion()->isVariant()) {
+            if(get<uint8>()) {
+                PVFieldPtr val(create->createPVField(getType()));
+                loadValue(*val);
+                pv.set(val);
+            } else {
+                pv.set(PVFieldPtr());
+            }
+        } else {
+            int32 sel = get<int32>();
+            if(sel!=PVUnion::UNDEFINED_INDEX && (sel<0 || size_t(sel)>=pv.getUnion()->getNumberFields()))
+                throw std::runtime_error("loadFromFile: Invalid union selector");
+            PVFieldPtr val(pv.select(sel));
+            if(val)
+                loadValue(*val);
+        }
+    }
+};
+
+void FileReader::loadValue(PVField& pv)
+{
+    switch(pv.getField()->getType()) {
+    case scalar: {
+        PVScalar& S = static_cast<PVScalar&>(pv);
+        switch(S.getScalar()->getScalarType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv##PVACODE: loadScalar<PVATYPE>(S); return;
+#define CASE_REAL_INT64
+#include <pv/typemap.h>
+#undef CASE_REAL_INT64
+#undef CASE
+        case pvString: static_cast<PVString&>(S).put(getString()); return;
+        }
+        break;
+    }
+    case scalarArray: {
+        PVScalarArray& A = static_cast<PVScalarArray&>(pv);
+        switch(A.getScalarArray()->getElementType()) {
+#define CASE(BASETYPE, PVATYPE, DBFTYPE, PVACODE) case pv##PVACODE: loadArray<PVATYPE>(A); return;
+#define CASE_REAL_INT64
+#include <pv/typemap.h>
+#undef CASE_REAL_INT64
+#undef CASE
+        case pvString: {
+            PVStringArray::svector arr(getCount(sizeof(uint32)));
+            for(size_t i=0, N=arr.size(); i<N; i++)
+                arr[i] = getString();
+            static_cast<PVStringArray&>(A).replace(freeze(arr));
+            return;
+        }
+        }
+        break;
+    }
+    case structure:
+        loadStructure(static_cast<PVStructure&>(pv));
+        return;
+    case structureArray: {
+        PVStructureArray& A = static_cast<PVStructureArray&>(pv);
+        StructureConstPtr type(A.getStructureArray()->getStructure());
+        PVStructureArray::svector arr(getCount(1));
+        for(size_t i=0, N=arr.size(); i<N; i++) {
+            if(get<uint8>()) {
+                arr[i] = create->createPVStructure(type);
+                loadStructure(*arr[i]);
+            }
+        }
+        A.replace(freeze(arr));
+        return;
+    }
+    case union_:
+        loadUnion(static_cast<PVUnion&>(pv));
+        return;
+    case unionArray: {
+        PVUnionArray& A = static_cast<PVUnionArray&>(pv);
+        UnionConstPtr type(A.getUnionArray()->getUnion());
+        PVUnionArray::svector arr(getCount(1));
+        for(size_t i=0, N=arr.size(); i<N; i++) {
+            if(get<uint8>()) {
+                arr[i] = create->createPVUnion(type);
+                loadUnion(*arr[i]);
+            }
+        }
+        A.replace(freeze(arr));
+        return;
+    }
+    }
+    THROW_EXCEPTION2(std::logic_error, "loadFromFile: unknown field type");
+}
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+void saveToFile(const PVStructure& value, const std::string& path)
+{
+    FileWriter W(path);
+
+    W.write(fileMagic, sizeof(fileMagic));
+    W.put<uint8>(fileVersion);
+    W.put<uint8>(EPICS_BYTE_ORDER==EPICS_ENDIAN_BIG ? 1 : 0);
+    W.put<uint16>(0);
+    W.putType(value.getStructure());
+
+    W.saveStructure(value);
+
+    W.close();
+}
+
+PVStructure::shared_pointer loadFromFile(const std::string& path)
+{
+    FileMapping::shared_pointer mapping(new FileMapping(path));
+
+    if(mapping->size < 12u || memcmp(mapping->base, fileMagic, sizeof(fileMagic))!=0)
+        throw std::runtime_error("loadFromFile: Not a PVData file '"+path+"'");
+    if(uint8(mapping->base[4])!=fileVersion)
+        throw std::runtime_error("loadFromFile: Unsupported file version '"+path+"'");
+
+    FileReader R(mapping, mapping->base[5] ? EPICS_ENDIAN_BIG : EPICS_ENDIAN_LITTLE);
+    R.buf.setPosition(8);
+
+    StructureConstPtr type(std::tr1::dynamic_pointer_cast<const Structure>(R.getType()));
+    if(!type)
+        throw std::runtime_error("loadFromFile: Not a PVStructure '"+path+"'");
+
+    PVStructure::shared_pointer ret(R.create->createPVStructure(type));
+    R.loadStructure(*ret);
+    return ret;
+}
+
+}} // namespace epics::pvData
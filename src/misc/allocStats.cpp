@@ -0,0 +1,100 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <string.h>
+
+#include <epicsThread.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvdVersion.h>
+#include <pv/reftrack.h>
+#include <pv/allocStats.h>
+
+namespace {
+
+using epics::ShardedCounter;
+
+// zero initialized, before any static constructors
+ShardedCounter counters[epics::detail::allocNKinds];
+
+const char * const counterNames[epics::detail::allocNKinds] = {
+    "bytes:shared_vector<boolean>",
+    "bytes:shared_vector<byte>",
+    "bytes:shared_vector<short>",
+    "bytes:shared_vector<int>",
+    "bytes:shared_vector<long>",
+    "bytes:shared_vector<ubyte>",
+    "bytes:shared_vector<ushort>",
+    "bytes:shared_vector<uint>",
+    "bytes:shared_vector<ulong>",
+    "bytes:shared_vector<float>",
+    "bytes:shared_vector<double>",
+    "bytes:shared_vector<string>",
+    "bytes:shared_vector<other>",
+    "bytes:PVField",
+    "bytes:Field",
+    "bytes:ByteBuffer",
+};
+
+// 0 - $PVD_ALLOC_STATS not yet read, 1 - disabled, 2 - enabled
+int allocState;
+
+void registerCounters(void *)
+{
+    for(size_t i=0; i<epics::detail::allocNKinds; i++)
+        epics::registerRefCounter(counterNames[i], &counters[i]);
+}
+
+epicsThreadOnceId registerOnce = EPICS_THREAD_ONCE_INIT;
+
+} // namespace
+
+namespace epics {
+
+bool enableAllocStats()
+{
+#ifdef REFTRACK_USE_ATOMIC
+    epicsThreadOnce(&registerOnce, &registerCounters, 0);
+    atomic::set(allocState, 2);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool allocStatsEnabled()
+{
+#ifdef REFTRACK_USE_ATOMIC
+    int state = atomic::get(allocState);
+    if(state==0) {
+        const char *env = getenv("PVD_ALLOC_STATS");
+        int want = env && (strcmp(env, "YES")==0 || strcmp(env, "1")==0) ? 2 : 1;
+        state = atomic::compareAndSwap(allocState, 0, want);
+        if(state==0)
+            state = want;
+        if(state==2)
+            epicsThreadOnce(&registerOnce, &registerCounters, 0);
+    }
+    return state==2;
+#else
+    return false;
+#endif
+}
+
+namespace detail {
+
+void allocAdd(AllocKind kind, size_t bytes)
+{
+    counters[kind].add(bytes);
+}
+
+void allocSub(AllocKind kind, size_t bytes)
+{
+    counters[kind].sub(bytes);
+}
+
+} // namespace detail
+
+} // namespace epics
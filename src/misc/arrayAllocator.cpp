@@ -0,0 +1,105 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <stdexcept>
+#include <new>
+
+#include <stdlib.h>
+
+#include <epicsThread.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvdVersion.h>
+#include <pv/arrayAllocator.h>
+
+namespace {
+
+using epics::pvData::ArrayAllocator;
+
+// allocator of the calling thread, points to ArrayAllocator::Scope::allocator
+#if __cplusplus>=201103L
+thread_local const ArrayAllocator::shared_pointer *currentAlloc;
+const ArrayAllocator::shared_pointer *getCurrent() { return currentAlloc; }
+void setCurrent(const ArrayAllocator::shared_pointer *A) { currentAlloc = A; }
+
+#elif defined(__GNUC__)
+__thread const ArrayAllocator::shared_pointer *currentAlloc;
+const ArrayAllocator::shared_pointer *getCurrent() { return currentAlloc; }
+void setCurrent(const ArrayAllocator::shared_pointer *A) { currentAlloc = A; }
+
+#else
+epicsThreadPrivateId currentId;
+epicsThreadOnceId currentOnce = EPICS_THREAD_ONCE_INIT;
+void currentInit(void *) { currentId = epicsThreadPrivateCreate(); }
+const ArrayAllocator::shared_pointer *getCurrent()
+{
+    epicsThreadOnce(&currentOnce, &currentInit, 0);
+    return static_cast<const ArrayAllocator::shared_pointer *>(epicsThreadPrivateGet(currentId));
+}
+void setCurrent(const ArrayAllocator::shared_pointer *A)
+{
+    epicsThreadOnce(&currentOnce, &currentInit, 0);
+    epicsThreadPrivateSet(currentId, const_cast<ArrayAllocator::shared_pointer *>(A));
+}
+#endif
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+ArrayAllocator::~ArrayAllocator() {}
+
+ArrayAllocator::shared_pointer ArrayAllocator::current()
+{
+    const shared_pointer *A = getCurrent();
+    return A ? *A : shared_pointer();
+}
+
+ArrayAllocator::Scope::Scope(const shared_pointer& allocator)
+    :allocator(allocator)
+    ,prev(getCurrent())
+{
+    // an empty allocator selects new[] for this scope
+    setCurrent(allocator ? &this->allocator : 0);
+}
+
+ArrayAllocator::Scope::~Scope()
+{
+    setCurrent(prev);
+}
+
+AlignedAllocator::AlignedAllocator(size_t alignment)
+    :alignment(alignment<sizeof(void*) ? sizeof(void*) : alignment)
+{
+    if(alignment==0u || (alignment&(alignment-1u)))
+        throw std::invalid_argument("AlignedAllocator alignment must be a power of two");
+}
+
+AlignedAllocator::~AlignedAllocator() {}
+
+/* Over-allocate with malloc() and round up.
+ * The pointer returned by malloc() is stored just before the aligned block.
+ */
+void* AlignedAllocator::allocate(size_t bytes)
+{
+    if(bytes > size_t(-1) - alignment - sizeof(void*))
+        throw std::bad_alloc();
+    char *raw = static_cast<char*>(malloc(bytes + alignment + sizeof(void*)));
+    if(!raw)
+        throw std::bad_alloc();
+    size_t addr = size_t(raw + sizeof(void*));
+    addr = (addr + alignment - 1u) & ~(alignment - 1u);
+    void **ret = reinterpret_cast<void**>(addr);
+    ret[-1] = raw;
+    return ret;
+}
+
+void AlignedAllocator::deallocate(void* ptr, size_t bytes)
+{
+    if(ptr)
+        free(static_cast<void**>(ptr)[-1]);
+}
+
+}} // namespace epics::pvData
@@ -68,4 +68,35 @@ bool Event::tryWait ()
     return status==epicsEventWaitOK ? true : false;
 }
 
+SpinEvent::SpinEvent(bool full, unsigned spins, unsigned maxBackoff)
+    :event(full)
+    ,spins(detail::singleCPU() ? 0u : spins)
+    ,maxBackoff(maxBackoff)
+{}
+
+SpinEvent::~SpinEvent() {}
+
+bool SpinEvent::spin()
+{
+    if(event.tryWait())
+        return true;
+    SpinBackoff backoff(maxBackoff);
+    for(unsigned i=0; i<spins; i++) {
+        backoff.pause();
+        if(event.tryWait())
+            return true;
+    }
+    return false;
+}
+
+bool SpinEvent::wait ()
+{
+    return spin() || event.wait();
+}
+
+bool SpinEvent::wait ( double timeOut )
+{
+    return spin() || event.wait(timeOut);
+}
+
 }}
@@ -0,0 +1,312 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+
+#if __cplusplus>=201103L
+#  include <chrono>
+#endif
+
+#include <epicsGuard.h>
+#include <epicsMutex.h>
+#include <epicsThread.h>
+#include <epicsTime.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvdVersion.h>
+#include <pv/byteBuffer.h>
+#include <pv/reftrack.h>
+#include <pv/latency.h>
+
+namespace {
+
+using epics::LatencyHistogram;
+
+typedef epicsGuard<epicsMutex> Guard;
+
+static inline
+size_t readval(const size_t *ref)
+{
+#ifdef REFTRACK_USE_ATOMIC
+    return epics::atomic::get(*ref);
+#else
+    volatile const size_t *vref = ref;
+    return *vref;
+#endif
+}
+
+static inline
+void addval(size_t& ref, size_t val)
+{
+#ifdef REFTRACK_USE_ATOMIC
+    epics::atomic::add(ref, val);
+#else
+    ref += val; // not thread safe
+#endif
+}
+
+// Difference of two values read from a size_t counter, which may have wrapped.
+// Subtract with the width of size_t, not epicsUInt64, for 32-bit targets.
+static inline
+epicsUInt64 diffval(epicsUInt64 after, epicsUInt64 before)
+{
+    return size_t(size_t(after) - size_t(before));
+}
+
+// built in probes
+LatencyHistogram probes[epics::detail::latencyNProbes];
+
+const char * const probeNames[epics::detail::latencyNProbes] = {
+    "PVStructure::serialize",
+    "PVStructure::serialize(BitSet)",
+    "PVStructure::deserialize",
+    "PVStructure::deserialize(BitSet)",
+    "FieldCreate::deserialize",
+    "PVRequestMapper::copyBaseToRequested",
+    "castUnsafeV",
+};
+
+struct latgbl_t {
+    epicsMutex lock;
+    typedef std::map<std::string, const LatencyHistogram*> hists_t;
+    hists_t hists;
+} *latgbl;
+
+void latgbl_init(void *)
+{
+    try {
+        latgbl = new latgbl_t;
+        for(size_t i=0; i<epics::detail::latencyNProbes; i++)
+            latgbl->hists[probeNames[i]] = &probes[i];
+    } catch(std::exception& e) {
+        std::cerr<<"Failed to initialize latency histogram registry :"<<e.what()<<"\n";
+    }
+}
+
+epicsThreadOnceId latgbl_once = EPICS_THREAD_ONCE_INIT;
+
+void latgbl_setup()
+{
+    epicsThreadOnce(&latgbl_once, &latgbl_init, 0);
+    if(!latgbl)
+        throw std::runtime_error("Failed to initialize latency histogram registry");
+}
+
+epicsUInt64 nowns()
+{
+#if __cplusplus>=201103L
+    return epicsUInt64(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           std::chrono::steady_clock::now().time_since_epoch()).count());
+#elif EPICS_VERSION_INT>=VERSION_INT(3,16,1,0)
+    return epicsMonotonicGet();
+#else
+    epicsTimeStamp now;
+    epicsTimeGetCurrent(&now);
+    return epicsUInt64(now.secPastEpoch)*1000000000u + now.nsec;
+#endif
+}
+
+// bit mask of probes active in the current thread
+#if __cplusplus>=201103L
+thread_local unsigned activeProbes;
+#elif defined(__GNUC__)
+__thread unsigned activeProbes;
+#else
+// no thread local storage.  time every call, including nested
+#  define PVD_LATENCY_NO_TLS
+#endif
+
+} // namespace
+
+namespace epics {
+
+size_t LatencyHistogram::bucketOf(epicsUInt64 ns)
+{
+    if(ns<epicsUInt64(subCount))
+        return size_t(ns);
+    unsigned msb = 0u;
+    for(epicsUInt64 v=ns; v>1u; v>>=1u)
+        msb++;
+    return (msb-subBits+1u)*subCount + size_t((ns>>(msb-subBits)) & (subCount-1u));
+}
+
+epicsUInt64 LatencyHistogram::bucketLow(size_t index)
+{
+    if(index<size_t(subCount))
+        return index;
+    unsigned msb = unsigned(index/subCount) + subBits - 1u;
+    epicsUInt64 sub = index%subCount;
+    return (epicsUInt64(subCount)+sub)<<(msb-subBits);
+}
+
+epicsUInt64 LatencyHistogram::bucketHigh(size_t index)
+{
+    if(index+1u>=size_t(nbuckets))
+        return ~epicsUInt64(0u);
+    return bucketLow(index+1u)-1u;
+}
+
+void LatencyHistogram::record(epicsUInt64 ns, size_t nbytes)
+{
+    addval(buckets[bucketOf(ns)], 1u);
+    addval(count, 1u);
+    addval(bytes, nbytes);
+    addval(totalns, size_t(ns));
+}
+
+void registerLatencyHistogram(const char *name, const LatencyHistogram* hist)
+{
+    latgbl_setup();
+    Guard G(latgbl->lock);
+    latgbl->hists[name] = hist;
+}
+
+void unregisterLatencyHistogram(const char *name, const LatencyHistogram* hist)
+{
+    latgbl_setup();
+    Guard G(latgbl->lock);
+    latgbl_t::hists_t::iterator it(latgbl->hists.find(name));
+    if(it!=latgbl->hists.end() && it->second==hist)
+        latgbl->hists.erase(it);
+}
+
+bool latencyInstrumented()
+{
+#ifdef PVD_LATENCY_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+epicsUInt64 LatencySnapshot::Stats::percentile(double fraction) const
+{
+    if(!count || buckets.empty())
+        return 0u;
+    epicsUInt64 target = epicsUInt64(fraction*count+0.5);
+    if(target<1u)
+        target = 1u;
+    epicsUInt64 seen = 0u;
+    for(size_t i=0; i<buckets.size(); i++) {
+        seen += buckets[i];
+        if(seen>=target)
+            return LatencyHistogram::bucketHigh(i);
+    }
+    return LatencyHistogram::bucketHigh(buckets.size()-1u);
+}
+
+void LatencySnapshot::update()
+{
+    latgbl_t::hists_t hists;
+    {
+        latgbl_setup();
+        Guard G(latgbl->lock);
+        hists = latgbl->hists; // copy
+    }
+
+    stats.clear();
+
+    for(latgbl_t::hists_t::const_iterator it=hists.begin(), end=hists.end();
+        it!=end; ++it)
+    {
+        const LatencyHistogram& H = *it->second;
+        Stats& S = stats[it->first];
+        S.count = readval(&H.count);
+        S.bytes = readval(&H.bytes);
+        S.totalns = readval(&H.totalns);
+        S.buckets.resize(LatencyHistogram::nbuckets);
+        for(size_t i=0; i<size_t(LatencyHistogram::nbuckets); i++)
+            S.buckets[i] = readval(&H.buckets[i]);
+    }
+}
+
+const LatencySnapshot::Stats&
+LatencySnapshot::operator[](const std::string& name) const
+{
+    static const Stats zero;
+
+    stats_map_t::const_iterator it(stats.find(name));
+    return it==stats.end() ? zero : it->second;
+}
+
+LatencySnapshot LatencySnapshot::operator-(const LatencySnapshot& rhs) const
+{
+    LatencySnapshot ret(*this);
+
+    for(stats_map_t::iterator it=ret.stats.begin(), end=ret.stats.end(); it!=end; ++it)
+    {
+        stats_map_t::const_iterator rit(rhs.stats.find(it->first));
+        if(rit==rhs.stats.end())
+            continue;
+        Stats& S = it->second;
+        const Stats& R = rit->second;
+        S.count = diffval(S.count, R.count);
+        S.bytes = diffval(S.bytes, R.bytes);
+        S.totalns = diffval(S.totalns, R.totalns);
+        for(size_t i=0; i<S.buckets.size() && i<R.buckets.size(); i++)
+            S.buckets[i] = diffval(S.buckets[i], R.buckets[i]);
+    }
+
+    return ret;
+}
+
+std::ostream& operator<<(std::ostream& strm, const LatencySnapshot& snap)
+{
+    for(LatencySnapshot::const_iterator it = snap.begin(), end = snap.end(); it!=end; ++it)
+    {
+        const LatencySnapshot::Stats& S = it->second;
+        if(!S.count) continue;
+        strm<<it->first<<":\t"<<S.count<<" calls, "<<S.bytes<<" bytes, mean "
+            <<std::fixed<<std::setprecision(3)<<S.mean()*1e-3
+            <<" us, p50 "<<S.percentile(0.5)*1e-3
+            <<" us, p99 "<<S.percentile(0.99)*1e-3
+            <<" us, max "<<S.percentile(1.0)*1e-3<<" us\n";
+    }
+    return strm;
+}
+
+namespace detail {
+
+LatencyScope::LatencyScope(LatencyProbe probe, const pvData::ByteBuffer *buf)
+    :probe(probe)
+#ifdef PVD_LATENCY_NO_TLS
+    ,outer(true)
+#else
+    ,outer(!(activeProbes&(1u<<probe)))
+#endif
+    ,buf(buf)
+    ,startpos(buf ? buf->getPosition() : 0u)
+    ,nbytes(0u)
+    ,start(0u)
+{
+    if(outer) {
+#ifndef PVD_LATENCY_NO_TLS
+        activeProbes |= 1u<<probe;
+#endif
+        start = nowns();
+    }
+}
+
+LatencyScope::~LatencyScope()
+{
+    if(!outer)
+        return;
+    epicsUInt64 end = nowns();
+#ifndef PVD_LATENCY_NO_TLS
+    activeProbes &= ~(1u<<probe);
+#endif
+    if(buf) {
+        size_t pos = buf->getPosition();
+        if(pos>startpos)
+            nbytes = pos-startpos;
+    }
+    probes[probe].record(end>start ? end-start : 0u, nbytes);
+}
+
+} // namespace detail
+
+} // namespace epics
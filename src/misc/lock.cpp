@@ -0,0 +1,35 @@
+/* lock.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <epicsThread.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvdVersion.h>
+#include <pv/lock.h>
+
+namespace epics { namespace pvData {
+namespace detail {
+
+namespace {
+bool checkSingleCPU()
+{
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,0,2)
+    return epicsThreadGetCPUs()<=1;
+#else
+    return false;
+#endif
+}
+}
+
+bool singleCPU()
+{
+    // epicsThreadGetCPUs() may read from /sys, so only ask once
+    static const bool single = checkSingleCPU();
+    return single;
+}
+
+} // namespace detail
+}} // namespace epics::pvData
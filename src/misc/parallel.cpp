@@ -0,0 +1,163 @@
+/* parallel.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <stdexcept>
+
+#include <epicsThread.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvdVersion.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/threadPool.h>
+#include <pv/parallel.h>
+
+namespace {
+using namespace epics::pvData;
+
+// state of one call to execute(), shared with helper tasks
+struct Parts {
+    Mutex lock;
+    Event done;
+
+    // guarded by lock
+    ParallelWork *work;
+    size_t nparts, next, pending;
+    std::string error;
+
+    Parts(ParallelWork& work, size_t nparts)
+        :work(&work)
+        ,nparts(nparts), next(0u), pending(nparts)
+    {}
+
+    // run parts until none remain
+    void runParts()
+    {
+        Lock G(lock);
+        while(next<nparts) {
+            ParallelWork *W = work;
+            size_t part = next++;
+            std::string msg;
+            G.unlock();
+            try {
+                W->run(part);
+            } catch(std::exception& e) {
+                msg = e.what();
+                if(msg.empty())
+                    msg = "ParallelWork::run() error";
+            }
+            G.lock();
+            if(!msg.empty() && error.empty())
+                error.swap(msg);
+            if(--pending==0)
+                done.signal();
+        }
+    }
+};
+
+struct Helper : public Runnable {
+    const std::tr1::shared_ptr<Parts> parts;
+    explicit Helper(const std::tr1::shared_ptr<Parts>& parts) :parts(parts) {}
+    virtual ~Helper() {}
+    virtual void run() { parts->runParts(); }
+};
+
+struct PoolExecutor : public ParallelExecutor {
+    const ThreadPool::shared_pointer pool; // NULL to run all parts in the caller
+
+    explicit PoolExecutor(const ThreadPool::shared_pointer& pool) :pool(pool) {}
+    virtual ~PoolExecutor() {}
+
+    virtual void execute(size_t N, ParallelWork& W)
+    {
+        if(!pool || N<=1) {
+            for(size_t i=0; i<N; i++)
+                W.run(i);
+            return;
+        }
+
+        std::tr1::shared_ptr<Parts> parts(new Parts(W, N));
+
+        // Helpers which start after all parts are taken do nothing.
+        // A full, or shut down, pool leaves more parts for the caller.
+        for(size_t i=0, n=std::min(pool->workers(), N-1); i<n; i++) {
+            ThreadPool::task_t helper(new Helper(parts));
+            if(!pool->trySubmit(helper))
+                break;
+        }
+
+        parts->runParts();
+
+        std::string msg;
+        {
+            Lock G(parts->lock);
+            while(parts->pending) {
+                G.unlock();
+                parts->done.wait();
+                G.lock();
+            }
+            parts->work = 0;
+            msg.swap(parts->error);
+        }
+        if(!msg.empty())
+            throw std::runtime_error(msg);
+    }
+
+    virtual size_t concurrency() const
+    {
+        return pool ? pool->workers()+1u : 1u;
+    }
+};
+
+ParallelExecutor::shared_pointer *defaultExecutor;
+
+void createDefault(void*)
+{
+    size_t ncpu = 1u;
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,0,2)
+    int n = epicsThreadGetCPUs();
+    if(n>1)
+        ncpu = size_t(n);
+#endif
+    defaultExecutor = new ParallelExecutor::shared_pointer(ParallelExecutor::create(std::min(ncpu-1u, size_t(8u))));
+}
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+ParallelWork::~ParallelWork() {}
+
+ParallelExecutor::~ParallelExecutor() {}
+
+ParallelExecutor::shared_pointer ParallelExecutor::create(size_t nworkers)
+{
+    ThreadPool::shared_pointer pool;
+    if(nworkers)
+        pool.reset(new ThreadPool(ThreadPool::Config()
+                                  .workers(nworkers)
+                                  .prio(epicsThreadGetPrioritySelf())
+                                  .name("PVDParallel")));
+    return create(pool);
+}
+
+ParallelExecutor::shared_pointer ParallelExecutor::create(const ThreadPool::shared_pointer& pool)
+{
+    ParallelExecutor::shared_pointer ret(new PoolExecutor(pool));
+    return ret;
+}
+
+const ParallelExecutor::shared_pointer& ParallelExecutor::getDefault()
+{
+    static epicsThreadOnceId once = EPICS_THREAD_ONCE_INIT;
+    epicsThreadOnce(&once, &createDefault, 0);
+    return *defaultExecutor;
+}
+
+}} // namespace epics::pvData
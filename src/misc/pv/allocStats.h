@@ -0,0 +1,114 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+/** @page pvd_allocstats Allocation accounting
+ *
+ * allocStats.h counts the bytes currently allocated for some kinds of objects.
+ * The counts are exposed as @ref pvd_reftrack counters, so RefSnapshot (and "refshow" et al.)
+ * can be used to find what is growing.
+ *
+ *  - "bytes:shared_vector<double>" etc. Arrays allocated by shared_vector, by element type.
+ *    Only the array itself, not eg. the characters of each std::string.
+ *    Arrays of non-scalar types are counted in "bytes:shared_vector<other>".
+ *  - "bytes:PVField" All PVField instances.
+ *  - "bytes:Field" All Field (introspection) instances.
+ *  - "bytes:ByteBuffer" Buffers allocated by ByteBuffer.  Not wrapped buffers.
+ *
+ * Accounting is disabled by default.  It is enabled from the first allocation by setting
+ * the environment variable PVD_ALLOC_STATS=YES , or later by calling enableAllocStats().
+ * Once enabled, it can not be disabled.
+ *
+ * shared_vector arrays allocated before accounting is enabled are never counted.
+ * A PVField, Field, or ByteBuffer allocated before, but released after,
+ * is subtracted without having been added.  So when enabled late, rely on the deltas.
+ *
+ * @code
+ *   epics::enableAllocStats();
+ *   epics::RefSnapshot before;
+ *   before.update();
+ *   ... work ...
+ *   epics::RefSnapshot after;
+ *   after.update();
+ *   std::cout<<(after-before);
+ * @endcode
+ */
+
+#include <stdlib.h>
+
+#include <shareLib.h>
+
+namespace epics {
+
+/** Enable allocation accounting from now on.
+ *
+ * @returns true if accounting is enabled.  false if the atomic operations needed are not available.
+ * @version Added after 8.0.0
+ */
+epicsShareFunc
+bool enableAllocStats();
+
+/** true if allocations are being counted.
+ *
+ * The first call reads $PVD_ALLOC_STATS , unless enableAllocStats() was called.
+ * @version Added after 8.0.0
+ */
+epicsShareFunc
+bool allocStatsEnabled();
+
+namespace detail {
+//! Kinds of allocation.  The first values match ScalarType
+enum AllocKind {
+    allocBoolean,
+    allocByte,
+    allocShort,
+    allocInt,
+    allocLong,
+    allocUByte,
+    allocUShort,
+    allocUInt,
+    allocULong,
+    allocFloat,
+    allocDouble,
+    allocString,
+    allocOther,
+    allocPVField,
+    allocField,
+    allocByteBuffer,
+    allocNKinds
+};
+
+//! Count an allocation.  Only call when allocStatsEnabled()
+epicsShareFunc void allocAdd(AllocKind kind, size_t bytes);
+//! Count a release.  Only call when allocStatsEnabled()
+epicsShareFunc void allocSub(AllocKind kind, size_t bytes);
+
+/** operator new and delete for a class counted as 'kind'.
+ *
+ * The sized operator delete sees the size of the most derived type,
+ * as long as the class has a virtual destructor.
+ */
+template<AllocKind kind>
+struct counted_alloc {
+    static void* alloc(size_t size)
+    {
+        void *ret = ::operator new(size);
+        if(allocStatsEnabled())
+            allocAdd(kind, size);
+        return ret;
+    }
+    static void release(void *ptr, size_t size)
+    {
+        if(ptr && allocStatsEnabled())
+            allocSub(kind, size);
+        ::operator delete(ptr);
+    }
+};
+} // namespace detail
+
+} // namespace epics
+
+#endif // ALLOCSTATS_H
@@ -0,0 +1,94 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef ARRAYALLOCATOR_H
+#define ARRAYALLOCATOR_H
+
+#include <stdlib.h>
+
+#include <pv/sharedPtr.h>
+#include <pv/noDefaultMethods.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/** @brief Source of memory for shared_vector arrays.
+ *
+ * By default shared_vector allocates arrays with new[].
+ * An ArrayAllocator may instead be given to shared_vector(size_t, const ArrayAllocator::shared_pointer&)
+ * and shared_vector::reserve(size_t, const ArrayAllocator::shared_pointer&),
+ * or made the default for the calling thread with an ArrayAllocator::Scope .
+ * eg. to place arrays in aligned memory, huge pages, a pool, or a pre-registered DMA region.
+ *
+ * Elements are constructed in, and destroyed before, the memory returned.
+ * Each array keeps a reference to its allocator until released, which may be
+ * in another thread, after freeze() and thaw() or casts to shared_vector<void>.
+ *
+ * @code
+ *   ArrayAllocator::shared_pointer aligned(new AlignedAllocator(64));
+ *   {
+ *       ArrayAllocator::Scope S(aligned);
+ *       shared_vector<double> arr(1024); // 64 byte aligned
+ *       arr.push_back(1.0);              // re-allocation also 64 byte aligned
+ *   }
+ * @endcode
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass ArrayAllocator {
+public:
+    POINTER_DEFINITIONS(ArrayAllocator);
+    virtual ~ArrayAllocator();
+
+    /** Allocate memory
+     *
+     * @param bytes Number of bytes, may be zero.
+     * @returns Memory aligned at least as for malloc() .  Never NULL.
+     * @throws std::bad_alloc if the allocation can not be made.
+     */
+    virtual void* allocate(size_t bytes) =0;
+    /** Release memory previously returned by allocate()
+     *
+     * May be called from any thread.
+     * @param ptr As returned by allocate()
+     * @param bytes As given to allocate()
+     */
+    virtual void deallocate(void* ptr, size_t bytes) =0;
+
+    //! The allocator set for the calling thread, or NULL to use new[]
+    static shared_pointer current();
+
+    /** Set the allocator for the calling thread for the lifetime of this object.
+     *
+     * Scopes may be nested.  The previous allocator is restored on destruction.
+     */
+    class epicsShareClass Scope {
+        EPICS_NOT_COPYABLE(Scope)
+        const shared_pointer allocator;
+        const shared_pointer *prev;
+    public:
+        explicit Scope(const shared_pointer& allocator);
+        ~Scope();
+    };
+};
+
+/** @brief ArrayAllocator returning memory aligned to a power of two.
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass AlignedAllocator : public ArrayAllocator {
+    const size_t alignment;
+public:
+    POINTER_DEFINITIONS(AlignedAllocator);
+    //! @throws std::invalid_argument if alignment is not a power of two.
+    explicit AlignedAllocator(size_t alignment = 64);
+    virtual ~AlignedAllocator();
+    virtual void* allocate(size_t bytes);
+    virtual void deallocate(void* ptr, size_t bytes);
+};
+
+}} // namespace epics::pvData
+
+#endif // ARRAYALLOCATOR_H
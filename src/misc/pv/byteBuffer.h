@@ -21,6 +21,7 @@
 #include <pv/templateMeta.h>
 #include <pv/pvType.h>
 #include <pv/epicsException.h>
+#include <pv/allocStats.h>
 
 
 #ifndef EPICS_ALWAYS_INLINE
@@ -248,6 +249,8 @@ public:
     {
         if(!_buffer)
             throw std::bad_alloc();
+        if(::epics::allocStatsEnabled())
+            ::epics::detail::allocAdd(::epics::detail::allocByteBuffer, _size);
         clear();
     }
 
@@ -274,7 +277,11 @@ public:
      */
     ~ByteBuffer()
     {
-        if (_buffer && !_wrapped) std::free(_buffer);
+        if (_buffer && !_wrapped) {
+            if(::epics::allocStatsEnabled())
+                ::epics::detail::allocSub(::epics::detail::allocByteBuffer, _size);
+            std::free(_buffer);
+        }
     }
     /**
      * Set the byte order.
@@ -0,0 +1,205 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef CHUNKEDVECTOR_H
+#define CHUNKEDVECTOR_H
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "pv/sharedVector.h"
+
+namespace epics { namespace pvData {
+
+/** @brief An array stored as a list of immutable segments (a rope).
+ *
+ * Appending a segment, and dropping elements from either end, do not copy
+ * array data, except that append() joins small segments.
+ * flatten() copies into a single contiguous array when one is needed.
+ *
+ * Segments are shared_vector<const E>, so may also be referenced elsewhere.
+ *
+ @code
+   chunked_vector<double> history;
+   ...
+   shared_vector<double> block(100);
+   ... fill block ...
+   history.push_back(freeze(block));
+   if(history.size() > 100000)
+       history.pop_front(history.size() - 100000);
+ @endcode
+ *
+ * @version Added after 8.0.0
+ */
+template<typename E>
+class chunked_vector
+{
+public:
+    typedef E value_type;
+    typedef shared_vector<const E> segment_type;
+    //! append() joins segments smaller than this many bytes
+    enum {coalesce_bytes = 4096};
+private:
+    // a vector, not a deque, as an empty deque allocates
+    typedef std::vector<segment_type> segments_t;
+    segments_t segs;
+    size_t first; // index in 'segs' of the first segment.  Earlier entries are empty.
+    size_t total;
+
+    static size_t smallSize() {
+        return sizeof(E)<size_t(coalesce_bytes) ? size_t(coalesce_bytes)/sizeof(E) : 1u;
+    }
+public:
+    typedef typename segments_t::const_iterator const_iterator;
+
+    chunked_vector() :first(0u), total(0u) {}
+    //! A single segment
+    explicit chunked_vector(const segment_type& s) :first(0u), total(0u) { push_back(s); }
+
+    //! Total number of elements
+    size_t size() const { return total; }
+    bool empty() const { return total==0u; }
+
+    //! Number of segments
+    size_t nsegments() const { return segs.size()-first; }
+    //! Iterate segments, in order.  No segment is empty.
+    const_iterator begin() const { return segs.begin()+first; }
+    const_iterator end() const { return segs.end(); }
+
+    //! Element access.  Linear in the number of segments.
+    const E& at(size_t i) const
+    {
+        for(const_iterator it(begin()), e(end()); it!=e; ++it) {
+            if(i < it->size())
+                return (*it)[i];
+            i -= it->size();
+        }
+        throw std::out_of_range("Index out of bounds");
+    }
+
+    //! Append a segment.  Does not copy.
+    void push_back(const segment_type& s)
+    {
+        if(s.empty())
+            return;
+        segs.push_back(s);
+        total += s.size();
+    }
+
+    //! Append all segments of another chunked_vector.  Does not copy.
+    void push_back(const chunked_vector& o)
+    {
+        for(const_iterator it(o.begin()), e(o.end()); it!=e; ++it)
+            push_back(*it);
+    }
+
+    /** Append a segment.  If both it and the last segment are smaller than
+     *  coalesce_bytes, they are joined by copying, so that appending a few
+     *  elements at a time does not build a long list of tiny segments.
+     */
+    void append(const segment_type& s)
+    {
+        const size_t small = smallSize();
+        if(s.empty())
+            return;
+        else if(nsegments()==0u || s.size()>=small || segs.back().size()>=small) {
+            push_back(s);
+            return;
+        }
+        // copies if the last segment is referenced elsewhere
+        shared_vector<E> last(thaw(segs.back()));
+        const size_t n = last.size();
+        if(last.capacity() < n+s.size())
+            last.reserve(std::max(n+s.size(), std::min(2u*n, small)));
+        last.resize(n+s.size());
+        std::copy(s.begin(), s.end(), last.begin()+n);
+        segs.back() = freeze(last);
+        total += s.size();
+    }
+
+    //! Remove n elements (or all) from the beginning
+    void pop_front(size_t n)
+    {
+        while(n && first<segs.size()) {
+            segment_type& front = segs[first];
+            if(n < front.size()) {
+                front.slice(n);
+                total -= n;
+                break;
+            }
+            n -= front.size();
+            total -= front.size();
+            front.clear();
+            first++;
+        }
+        if(first==segs.size()) {
+            clear();
+        } else if(2u*first > segs.size()) {
+            // amortized O(1)
+            segs.erase(segs.begin(), segs.begin()+first);
+            first = 0u;
+        }
+    }
+
+    //! Remove n elements (or all) from the end
+    void pop_back(size_t n)
+    {
+        while(n && first<segs.size()) {
+            segment_type& last = segs.back();
+            if(n < last.size()) {
+                last.slice(0, last.size()-n);
+                total -= n;
+                break;
+            }
+            n -= last.size();
+            total -= last.size();
+            segs.pop_back();
+        }
+        if(first==segs.size())
+            clear();
+    }
+
+    void clear()
+    {
+        segs.clear();
+        first = total = 0u;
+    }
+
+    void swap(chunked_vector& o)
+    {
+        segs.swap(o.segs);
+        std::swap(first, o.first);
+        std::swap(total, o.total);
+    }
+
+    //! Contiguous copy of all elements.  Does not copy if there is only one segment.
+    segment_type flatten() const
+    {
+        if(nsegments()==0u)
+            return segment_type();
+        else if(nsegments()==1u)
+            return segs[first];
+        shared_vector<E> ret;
+        ret.resize_uninitialized(total);
+        typename shared_vector<E>::iterator out(ret.begin());
+        for(const_iterator it(begin()), e(end()); it!=e; ++it)
+            out = std::copy(it->begin(), it->end(), out);
+        return freeze(ret);
+    }
+
+    //! Replace all segments with a single segment
+    void compact()
+    {
+        if(nsegments()<=1u)
+            return;
+        segment_type flat(flatten());
+        clear();
+        push_back(flat);
+    }
+};
+
+}} // namespace epics::pvData
+
+#endif // CHUNKEDVECTOR_H
@@ -0,0 +1,201 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef CIRCULARVECTOR_H
+#define CIRCULARVECTOR_H
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "pv/sharedVector.h"
+
+namespace epics { namespace pvData {
+
+/** @brief A fixed capacity array where push_back() onto a full array replaces the oldest element.
+ *
+ * Elements are stored in a single shared_vector, starting at a head index,
+ * and wrapping around to the beginning.
+ * push_back() is O(1), without shifting existing elements.
+ *
+ * spans() gives the contents, in order, as two shared_vector<const E> referencing
+ * the storage.  While such a reference exists, the next modification
+ * first copies the storage (as shared_vector::make_unique()), which is O(capacity()).
+ *
+ @code
+   circular_vector<double> strip(1000000);
+   ...
+   strip.push_back(sample); // replaces the oldest once full
+   ...
+   shared_vector<const double> older, newer;
+   strip.spans(older, newer);
+ @endcode
+ *
+ * @version Added after 8.0.0
+ */
+template<typename E>
+class circular_vector
+{
+public:
+    typedef E value_type;
+    typedef shared_vector<const E> span_type;
+private:
+    span_type buf;
+    size_t head, count;
+
+    // storage, first copied if referenced elsewhere
+    E* writable()
+    {
+        shared_vector<E> temp(thaw(buf));
+        E* ret = temp.data();
+        buf = freeze(temp);
+        return ret;
+    }
+
+    // index in 'buf' of logical element i
+    size_t index(size_t i) const {
+        i += head;
+        return i < buf.size() ? i : i - buf.size();
+    }
+public:
+    circular_vector() :head(0u), count(0u) {}
+    //! An empty array with the given capacity
+    explicit circular_vector(size_t cap) :buf(cap), head(0u), count(0u) {}
+
+    //! Number of elements
+    size_t size() const { return count; }
+    bool empty() const { return count==0u; }
+    //! Maximum number of elements
+    size_t capacity() const { return buf.size(); }
+
+    //! Element access, oldest first
+    const E& at(size_t i) const
+    {
+        if(i>=count)
+            throw std::out_of_range("Index out of bounds");
+        return buf[index(i)];
+    }
+
+    /** Change capacity.  When reduced, the newest elements are kept.
+     *  Always copies.
+     */
+    void reserve(size_t cap)
+    {
+        if(count > cap)
+            pop_front(count - cap);
+        shared_vector<E> next(cap);
+        span_type first, second;
+        spans(first, second);
+        std::copy(second.begin(), second.end(),
+                  std::copy(first.begin(), first.end(), next.begin()));
+        buf = freeze(next);
+        head = 0u;
+    }
+
+    //! Append one element.  When full, the oldest element is replaced.
+    void push_back(const E& v)
+    {
+        if(buf.empty())
+            return;
+        E* store = writable();
+        if(count < buf.size()) {
+            store[index(count++)] = v;
+        } else {
+            store[head] = v;
+            if(++head == buf.size())
+                head = 0u;
+        }
+    }
+
+    //! Append elements.  When full, the oldest elements are replaced.
+    void push_back(const E* v, size_t n)
+    {
+        if(buf.empty())
+            return;
+        if(n > buf.size()) {
+            // only the last capacity() elements are kept
+            v += n - buf.size();
+            n = buf.size();
+        }
+        E* store = writable();
+        for(size_t i=0; i<n; i++) {
+            if(count < buf.size()) {
+                store[index(count++)] = v[i];
+            } else {
+                store[head] = v[i];
+                if(++head == buf.size())
+                    head = 0u;
+            }
+        }
+    }
+
+    //! Remove up to n of the oldest elements
+    void pop_front(size_t n)
+    {
+        if(n > count)
+            n = count;
+        head = index(n);
+        count -= n;
+        if(count==0u)
+            head = 0u;
+    }
+
+    //! Remove up to n of the newest elements
+    void pop_back(size_t n)
+    {
+        if(n > count)
+            n = count;
+        count -= n;
+        if(count==0u)
+            head = 0u;
+    }
+
+    //! Remove all elements.  Capacity is not changed.
+    void clear()
+    {
+        head = count = 0u;
+    }
+
+    void swap(circular_vector& o)
+    {
+        buf.swap(o.buf);
+        std::swap(head, o.head);
+        std::swap(count, o.count);
+    }
+
+    /** The elements, oldest first, as two ranges.
+     *
+     * 'second' is empty unless the elements wrap around the end of storage.
+     * Does not copy.
+     */
+    void spans(span_type& first, span_type& second) const
+    {
+        const size_t firstLen = std::min(count, buf.size() - head);
+        first = second = buf;
+        first.slice(head, firstLen);
+        second.slice(0, count - firstLen);
+        // don't hold a reference to storage unnecessarily
+        if(first.empty())
+            first.clear();
+        if(second.empty())
+            second.clear();
+    }
+
+    //! Contiguous copy of all elements.  Does not copy if the elements do not wrap around.
+    span_type flatten() const
+    {
+        span_type first, second;
+        spans(first, second);
+        if(second.empty())
+            return first;
+        shared_vector<E> ret;
+        ret.resize_uninitialized(count);
+        std::copy(second.begin(), second.end(),
+                  std::copy(first.begin(), first.end(), ret.begin()));
+        return freeze(ret);
+    }
+};
+
+}} // namespace epics::pvData
+
+#endif // CIRCULARVECTOR_H
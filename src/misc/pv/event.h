@@ -17,6 +17,7 @@
 
 #include <pv/pvType.h>
 #include <pv/sharedPtr.h>
+#include <pv/lock.h>
 
 
 namespace epics { namespace pvData { 
@@ -64,5 +65,42 @@ private:
     epicsEventId id;
 };
 
+/**
+ * @brief An Event which spins briefly before blocking.
+ *
+ * wait() retries tryWait() up to 'spins' times, with exponential backoff,
+ * before blocking.  Useful when the signal is expected very soon,
+ * to avoid putting the waiting thread to sleep.
+ *
+ * Never spins when only one CPU is online.
+ * Otherwise the same as Event.
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass SpinEvent {
+    EPICS_NOT_COPYABLE(SpinEvent)
+public:
+    POINTER_DEFINITIONS(SpinEvent);
+    /**
+     * @param full Initial state
+     * @param spins Number of tryWait() attempts before blocking.  Zero to always block.
+     * @param maxBackoff Upper limit of busy wait iterations between attempts.
+     */
+    explicit SpinEvent(bool full = false, unsigned spins = 100u, unsigned maxBackoff = 64u);
+    ~SpinEvent();
+    //! @see Event::signal()
+    void signal() { event.signal(); }
+    //! @see Event::wait()
+    bool wait ();
+    //! @see Event::wait(double)
+    bool wait ( double timeOut );
+    //! @see Event::tryWait()
+    bool tryWait () { return event.tryWait(); }
+private:
+    bool spin();
+    Event event;
+    const unsigned spins, maxBackoff;
+};
+
 }}
 #endif  /* EVENT_H */
@@ -0,0 +1,185 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef LATENCY_H
+#define LATENCY_H
+
+/** @page pvd_latency Latency histograms
+ *
+ * latency.h records how long, and how many bytes, some hot paths of this library take.
+ * Analogous to @ref pvd_reftrack , and printed by RefMonitor.
+ *
+ * Instrumentation is compiled in only when the library is built with
+ * WITH_LATENCY_STATS=YES (eg. in configure/CONFIG_SITE.local), which defines PVD_LATENCY_STATS.
+ * Otherwise the probes are registered, but never record anything.
+ * latencyInstrumented() tells which.
+ *
+ * Built in probes, timing only the outermost call in each thread:
+ *  - "PVStructure::serialize" and "PVStructure::serialize(BitSet)"
+ *  - "PVStructure::deserialize" and "PVStructure::deserialize(BitSet)"
+ *  - "FieldCreate::deserialize"
+ *  - "PVRequestMapper::copyBaseToRequested"
+ *  - "castUnsafeV"
+ *
+ * Byte counts are the change in ByteBuffer position, which excludes
+ * any bytes flushed or fetched during the call.  For castUnsafeV(), the size
+ * of the destination.
+ *
+ * Other histograms may be added with registerLatencyHistogram().
+ *
+ * @code
+ *   epics::LatencySnapshot before;
+ *   before.update();
+ *   ... work ...
+ *   epics::LatencySnapshot after;
+ *   after.update();
+ *   std::cout<<(after-before);
+ * @endcode
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+#include <epicsTypes.h>
+#include <shareLib.h>
+
+namespace epics {
+namespace pvData {
+class ByteBuffer;
+}
+
+/** @brief Histogram of durations, with log-linear buckets.
+ *
+ * In the style of HdrHistogram.  Each power of two is split into 16 buckets,
+ * so each bucket is within about 6% of the recorded value.
+ *
+ * Has no constructor so that a static instance is zero initialized before
+ * any static constructors run.  Instances must have static storage duration,
+ * or be value initialized.
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass LatencyHistogram {
+public:
+    enum {
+        subBits = 4,
+        subCount = 1<<subBits,
+        nbuckets = (64-subBits+1)*subCount
+    };
+    //! Bucket index of a value
+    static size_t bucketOf(epicsUInt64 ns);
+    //! Smallest value in a bucket
+    static epicsUInt64 bucketLow(size_t index);
+    //! Largest value in a bucket
+    static epicsUInt64 bucketHigh(size_t index);
+
+    //! Add one sample
+    void record(epicsUInt64 ns, size_t bytes = 0u);
+
+private:
+    size_t count, bytes, totalns; // totalns may wrap
+    size_t buckets[nbuckets];
+    friend class LatencySnapshot;
+};
+
+//! Register a histogram to be included by LatencySnapshot::update()
+epicsShareFunc
+void registerLatencyHistogram(const char *name, const LatencyHistogram* hist);
+
+//! Remove registration of a histogram
+epicsShareFunc
+void unregisterLatencyHistogram(const char *name, const LatencyHistogram* hist);
+
+//! true if the built in probes of this library were compiled in
+epicsShareFunc
+bool latencyInstrumented();
+
+//! Values of many histograms.  @version Added after 8.0.0
+class epicsShareClass LatencySnapshot
+{
+public:
+    struct epicsShareClass Stats {
+        epicsUInt64 count, bytes, totalns;
+        std::vector<epicsUInt64> buckets; //!< empty, or LatencyHistogram::nbuckets
+        Stats() :count(0u), bytes(0u), totalns(0u) {}
+        //! Mean in nanoseconds
+        double mean() const { return count ? double(totalns)/count : 0.0; }
+        //! Upper bound, in nanoseconds, of the value below which 'fraction' (0.0 -> 1.0) of samples fall
+        epicsUInt64 percentile(double fraction) const;
+    };
+
+private:
+    typedef std::map<std::string, Stats> stats_map_t;
+    stats_map_t stats;
+public:
+    typedef stats_map_t::const_iterator iterator;
+    typedef stats_map_t::const_iterator const_iterator;
+
+    //! Fetch values of all registered histograms.  Not a single atomic operation.
+    void update();
+
+    const Stats& operator[](const std::string& name) const;
+
+    iterator begin() const { return stats.begin(); }
+    iterator end() const { return stats.end(); }
+    size_t size() const { return stats.size(); }
+
+    inline void swap(LatencySnapshot& o)
+    {
+        stats.swap(o.stats);
+    }
+
+    /** Samples recorded between rhs and lhs.
+     *
+     * Histogram counters are size_t, so with a 32-bit size_t, totalns wraps after about 4.3 seconds.
+     * Differences are taken modulo the width of size_t, so are correct across a wrap,
+     * provided less than that elapses between the two snapshots.
+     */
+    LatencySnapshot operator-(const LatencySnapshot& rhs) const;
+};
+
+//! Print all histograms with samples
+epicsShareFunc
+std::ostream& operator<<(std::ostream& strm, const LatencySnapshot& snap);
+
+namespace detail {
+enum LatencyProbe {
+    latencySerialize,
+    latencySerializeBitSet,
+    latencyDeserialize,
+    latencyDeserializeBitSet,
+    latencyFieldDeserialize,
+    latencyCopyBaseToRequested,
+    latencyCastUnsafeV,
+    latencyNProbes
+};
+
+//! Times the lifetime of this object.  Only the outermost in each thread, for each probe.
+class epicsShareClass LatencyScope {
+    const LatencyProbe probe;
+    const bool outer;
+    const epics::pvData::ByteBuffer * const buf;
+    size_t startpos, nbytes;
+    epicsUInt64 start;
+public:
+    explicit LatencyScope(LatencyProbe probe, const epics::pvData::ByteBuffer *buf = 0);
+    ~LatencyScope();
+    //! Bytes to record, instead of ByteBuffer position change
+    void bytes(size_t n) { nbytes = n; }
+};
+} // namespace detail
+
+} // namespace epics
+
+#ifdef PVD_LATENCY_STATS
+#  define PVD_LATENCY_SCOPE(PROBE, BUF) ::epics::detail::LatencyScope pvd_latency_scope(::epics::detail::PROBE, BUF)
+#  define PVD_LATENCY_BYTES(N) pvd_latency_scope.bytes(N)
+#else
+#  define PVD_LATENCY_SCOPE(PROBE, BUF) do{}while(0)
+#  define PVD_LATENCY_BYTES(N) do{}while(0)
+#endif
+
+#endif // LATENCY_H
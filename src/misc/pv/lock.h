@@ -27,6 +27,93 @@ namespace epics { namespace pvData {
 
 typedef epicsMutex Mutex;
 
+namespace detail {
+//! true when only one CPU is online, and so spinning only delays the thread being waited for
+epicsShareFunc bool singleCPU();
+
+//! Hint to the CPU that the caller is busy waiting
+inline void cpuRelax()
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    __builtin_ia32_pause();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    __asm__ __volatile__ ("yield");
+#endif
+}
+}
+
+/**
+ * @brief Exponential backoff between busy wait attempts.
+ *
+ * Each pause() spins for twice as long as the last, up to maxDelay iterations.
+ *
+ * @version Added after 8.0.0
+ */
+class SpinBackoff {
+    unsigned delay;
+    const unsigned maxDelay;
+public:
+    explicit SpinBackoff(unsigned maxDelay) :delay(1u), maxDelay(maxDelay) {}
+    void pause()
+    {
+        for(unsigned i=0; i<delay; i++)
+            detail::cpuRelax();
+        if(delay<maxDelay)
+            delay <<= 1u;
+    }
+};
+
+/**
+ * @brief A Mutex which spins briefly before blocking.
+ *
+ * On contention, retry tryLock() up to 'spins' times, with exponential backoff,
+ * before falling back to a blocking lock().  Intended for very short critical
+ * sections, where the owner is likely to unlock before a blocked thread could be
+ * put to sleep and woken again.
+ *
+ * May be used with Lock, or epicsGuard.  Recursive, as Mutex.
+ * Never spins when only one CPU is online.
+ *
+ * @code
+ *   SpinMutex mutex;
+ *   {
+ *       Lock G(mutex);
+ *       ...
+ *   }
+ * @endcode
+ *
+ * @version Added after 8.0.0
+ */
+class SpinMutex {
+    EPICS_NOT_COPYABLE(SpinMutex)
+public:
+    /**
+     * @param spins Number of tryLock() attempts before blocking.  Zero to always block.
+     * @param maxBackoff Upper limit of busy wait iterations between attempts.
+     */
+    explicit SpinMutex(unsigned spins = 100u, unsigned maxBackoff = 64u)
+        :spins(detail::singleCPU() ? 0u : spins), maxBackoff(maxBackoff)
+    {}
+    void lock()
+    {
+        if(mutex.tryLock())
+            return;
+        SpinBackoff backoff(maxBackoff);
+        for(unsigned i=0; i<spins; i++) {
+            backoff.pause();
+            if(mutex.tryLock())
+                return;
+        }
+        mutex.lock();
+    }
+    void unlock() { mutex.unlock(); }
+    bool tryLock() { return mutex.tryLock(); }
+private:
+    Mutex mutex;
+    const unsigned spins, maxBackoff;
+    friend class Lock;
+};
+
 /**
  * @brief A lock for multithreading
  *
@@ -41,8 +128,15 @@ public:
      * @param m The mutex for the facility being locked.
      */
     explicit Lock(Mutex &m)
-    : mutexPtr(m), locked(true)
+    : mutexPtr(m), spinPtr(0), locked(true)
     { mutexPtr.lock();}
+    /**
+     * Constructor
+     * @param m The spinning mutex for the facility being locked.
+     */
+    explicit Lock(SpinMutex &m)
+    : mutexPtr(m.mutex), spinPtr(&m), locked(true)
+    { spinPtr->lock();}
     /**
      * Destructor
      * Note that destructor does an automatic unlock.
@@ -56,7 +150,10 @@ public:
     {
         if(!locked) 
         {
-            mutexPtr.lock();
+            if(spinPtr)
+                spinPtr->lock();
+            else
+                mutexPtr.lock();
             locked = true;
         }
     }
@@ -91,6 +188,7 @@ public:
     bool ownsLock() const{return locked;}
 private:
     Mutex &mutexPtr;
+    SpinMutex *spinPtr;
     bool locked;
 };
 
@@ -0,0 +1,84 @@
+/* parallel.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <cstddef>
+
+#include <pv/sharedPtr.h>
+#include <pv/noDefaultMethods.h>
+#include <pv/threadPool.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/** @brief A unit of work which can be divided into independent parts.
+ *
+ * @see ParallelExecutor
+ * @version Added after 8.0.0
+ */
+class epicsShareClass ParallelWork {
+public:
+    virtual ~ParallelWork();
+    //! Process part number 'part'.  Called at most once for each part, from any thread.
+    virtual void run(size_t part) =0;
+};
+
+/** @brief Executes the parts of a ParallelWork, possibly concurrently.
+ *
+ * Used to split operations on large arrays across CPU cores.
+ * Users may provide their own implementation to run on an existing pool of threads.
+ *
+ * @code
+ *   struct Sum : public ParallelWork {
+ *       ...
+ *       virtual void run(size_t part) { ... }
+ *   } work;
+ *   ParallelExecutor::getDefault()->execute(4, work);
+ * @endcode
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass ParallelExecutor {
+public:
+    POINTER_DEFINITIONS(ParallelExecutor);
+
+    virtual ~ParallelExecutor();
+
+    /** Call work.run(i) for each i in [0, nparts).  Return when all calls have completed.
+     *
+     * The calling thread may run some, or all, parts.
+     * @throws std::runtime_error If some call to run() throws, after all parts have completed.
+     */
+    virtual void execute(size_t nparts, ParallelWork& work) =0;
+
+    //! Number of threads which may run parts concurrently, including the caller.
+    virtual size_t concurrency() const =0;
+
+    /** Create an executor with a pool of worker threads.
+     * @param nworkers Number of worker threads, in addition to the calling thread.
+     *                 Zero executes all parts on the calling thread.
+     */
+    static shared_pointer create(size_t nworkers);
+
+    /** Create an executor which runs parts on an existing ThreadPool.
+     *
+     * The pool may be shared with other users.  If the pool is busy, or its queue is full,
+     * more parts are run by the calling thread.
+     * @param pool The pool.  If NULL, all parts are run by the calling thread.
+     */
+    static shared_pointer create(const ThreadPool::shared_pointer& pool);
+
+    /** A process wide executor with a worker for each additional CPU core (max. 8).
+     * Created on first use.
+     */
+    static const shared_pointer& getDefault();
+};
+
+}}
+
+#endif // PARALLEL_H
@@ -35,6 +35,12 @@
  *   // in some IOC registrar or global ctor
  *   registerRefCounter("MyClass", &MyClass::num_instances);
  * @endcode
+ *
+ * For classes whose instances are created and destroyed by many threads at a high rate,
+ * a ShardedCounter avoids contention on a single shared counter.
+ * Declare "static epics::ShardedCounter num_instances;" instead of size_t.
+ * Usage is otherwise the same.
+ * An existing size_t counter may be kept, for compatibility, with ShardedCounter::setTotal().
  */
 
 #ifdef __cplusplus
@@ -61,8 +67,8 @@
 #endif
 
 #ifdef REFTRACK_USE_ATOMIC
-#  define REFTRACE_INCREMENT(counter) ::epics::atomic::increment(counter)
-#  define REFTRACE_DECREMENT(counter) ::epics::atomic::decrement(counter)
+#  define REFTRACE_INCREMENT(counter) ::epics::detail::refIncrement(counter)
+#  define REFTRACE_DECREMENT(counter) ::epics::detail::refDecrement(counter)
 #else
 #  define REFTRACE_INCREMENT(counter) do{}while(0)
 #  define REFTRACE_DECREMENT(counter) do{}while(0)
@@ -70,15 +76,126 @@
 
 #include <shareLib.h>
 
+// Align a type to a cache line
+#if __cplusplus>=201103L
+#  define REFTRACK_CACHE_ALIGN alignas(64)
+#elif defined(__GNUC__)
+#  define REFTRACK_CACHE_ALIGN __attribute__((aligned(64)))
+#elif defined(_MSC_VER)
+#  define REFTRACK_CACHE_ALIGN __declspec(align(64))
+#else
+#  define REFTRACK_CACHE_ALIGN
+#endif
+
 namespace epics {
 
+namespace detail {
+//! Index of the ShardedCounter shard used by the calling thread
+epicsShareFunc unsigned refShard();
+}
+
+/** @brief Instance counter split into several shards, each on its own cache line.
+ *
+ * Each thread updates one shard, so threads do not contend for a single cache line.
+ * Reading sums all shards.  An instance may be destroyed by a different thread
+ * than created it, so single shards may wrap around, but the sum is correct.
+ *
+ * Has no constructor so that a static instance is zero initialized before
+ * any static constructors run.  Instances must have static storage duration,
+ * or be value initialized.
+ *
+ * Optionally, shards may be periodically added to a single size_t total.  @see setTotal()
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass ShardedCounter {
+public:
+    enum {nshards = 16};
+    //! A shard is added to the total once it differs from zero by this much
+    enum {flushAt = 64};
+private:
+    struct REFTRACK_CACHE_ALIGN Shard {
+        size_t count;
+        char pad[64-sizeof(size_t)];
+    };
+    Shard shards[nshards];
+    size_t *total;
+
+    void flush(Shard& S);
+
+    inline void update(Shard& S, size_t val)
+    {
+#ifdef REFTRACK_USE_ATOMIC
+        // shards count up, or down (wrapping around)
+        if(total && val+size_t(flushAt)-1u >= size_t(2*flushAt)-1u)
+            flush(S);
+#endif
+    }
+public:
+    inline void increment()
+    {
+#ifdef REFTRACK_USE_ATOMIC
+        Shard& S = shards[detail::refShard()];
+        update(S, ::epics::atomic::increment(S.count));
+#endif
+    }
+    inline void decrement()
+    {
+#ifdef REFTRACK_USE_ATOMIC
+        Shard& S = shards[detail::refShard()];
+        update(S, ::epics::atomic::decrement(S.count));
+#endif
+    }
+    //! Add n, eg. a number of bytes
+    inline void add(size_t n)
+    {
+#ifdef REFTRACK_USE_ATOMIC
+        Shard& S = shards[detail::refShard()];
+        update(S, ::epics::atomic::add(S.count, n));
+#endif
+    }
+    //! Subtract n
+    inline void sub(size_t n)
+    {
+#ifdef REFTRACK_USE_ATOMIC
+        Shard& S = shards[detail::refShard()];
+        update(S, ::epics::atomic::subtract(S.count, n));
+#endif
+    }
+    /** Also keep a single size_t counter, for existing users of a size_t counter.
+     *
+     * Shards are added to *total in batches, so *total lags the exact count by
+     * less than nshards*flushAt.  get() includes *total.
+     * Call once, before any other thread uses this counter.
+     */
+    void setTotal(size_t *total);
+    //! Sum of all shards, and total.  Not a single atomic operation.
+    size_t get() const;
+    operator size_t() const { return get(); }
+};
+
+namespace detail {
+inline void refIncrement(ShardedCounter& counter) { counter.increment(); }
+inline void refDecrement(ShardedCounter& counter) { counter.decrement(); }
+#ifdef REFTRACK_USE_ATOMIC
+inline void refIncrement(size_t& counter) { ::epics::atomic::increment(counter); }
+inline void refDecrement(size_t& counter) { ::epics::atomic::decrement(counter); }
+#endif
+}
+
 //! Register new global reference counter
 epicsShareFunc
 void registerRefCounter(const char *name, const size_t* counter);
+//! Register new global reference counter.  @version Added after 8.0.0
+epicsShareFunc
+void registerRefCounter(const char *name, const ShardedCounter* counter);
 
 //! Remove registration of global reference counter (if dynamically allocated)
 epicsShareFunc
 void unregisterRefCounter(const char *name, const size_t* counter);
+//! Remove registration of global reference counter.  @version Added after 8.0.0
+epicsShareFunc
+void unregisterRefCounter(const char *name, const ShardedCounter* counter);
 
 //! Fetch current value of single reference counter
 epicsShareFunc
@@ -134,8 +251,10 @@ public:
 epicsShareFunc
 std::ostream& operator<<(std::ostream& strm, const RefSnapshot& snap);
 
+class LatencySnapshot;
+
 //! Helper to run a thread which periodically prints (via show() )
-//! global reference counter deltas.
+//! global reference counter deltas, and (via showLatency() ) latency histograms.
 class epicsShareClass RefMonitor
 {
     struct Impl;
@@ -154,6 +273,10 @@ protected:
     //! Default prints to stderr
     //! @param complete when false show only non-zero delta, when true show non-zero count or delta
     virtual void show(const RefSnapshot& snap, bool complete=false);
+    //! Default prints histograms with samples to stderr.
+    //! @param snap samples since the previous call
+    //! @version Added after 8.0.0
+    virtual void showLatency(const LatencySnapshot& snap);
 };
 
 } // namespace epics
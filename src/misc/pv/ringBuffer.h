@@ -0,0 +1,309 @@
+/* ringBuffer.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <epicsVersion.h>
+#include <epicsTime.h>
+
+#ifndef VERSION_INT
+#  define VERSION_INT(V,R,M,P) ( ((V)<<24) | ((R)<<16) | ((M)<<8) | (P))
+#endif
+
+#ifndef EPICS_VERSION_INT
+#  define EPICS_VERSION_INT VERSION_INT(EPICS_VERSION, EPICS_REVISION, EPICS_MODIFICATION, EPICS_PATCH_LEVEL)
+#endif
+
+#if __cplusplus>=201103L
+#  include <atomic>
+#  define PVD_RING_STD_ATOMIC
+#elif EPICS_VERSION_INT>=VERSION_INT(3,15,1,0)
+#  include <epicsAtomic.h>
+#  define PVD_RING_EPICS_ATOMIC
+#endif
+
+#include <pv/noDefaultMethods.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+
+namespace epics { namespace pvData {
+
+namespace detail {
+
+// size_t with the memory ordering needed by Ring
+class RingIndex {
+    EPICS_NOT_COPYABLE(RingIndex)
+#if defined(PVD_RING_STD_ATOMIC)
+    std::atomic<size_t> val;
+public:
+    RingIndex() :val(0u) {}
+    inline size_t load() const { return val.load(std::memory_order_acquire); }
+    inline void store(size_t v) { val.store(v, std::memory_order_release); }
+    inline bool cas(size_t expect, size_t desired) { return val.compare_exchange_weak(expect, desired, std::memory_order_relaxed); }
+    inline void increment() { val.fetch_add(1u); }
+    inline void decrement() { val.fetch_sub(1u); }
+    // ordered after all preceding loads and stores
+    inline size_t syncLoad() const { std::atomic_thread_fence(std::memory_order_seq_cst); return val.load(); }
+#elif defined(PVD_RING_EPICS_ATOMIC)
+    size_t val;
+public:
+    RingIndex() :val(0u) {}
+    inline size_t load() const { size_t ret = epics::atomic::get(val); epicsAtomicReadMemoryBarrier(); return ret; }
+    inline void store(size_t v) { epicsAtomicWriteMemoryBarrier(); epics::atomic::set(val, v); }
+    inline bool cas(size_t expect, size_t desired) { return epics::atomic::compareAndSwap(val, expect, desired)==expect; }
+    inline void increment() { epics::atomic::increment(val); }
+    inline void decrement() { epics::atomic::decrement(val); }
+    inline size_t syncLoad() { return epics::atomic::add(val, size_t(0u)); }
+#else
+    // no atomic operations available.  fall back to locking.
+    mutable Mutex lock;
+    size_t val;
+public:
+    RingIndex() :val(0u) {}
+    inline size_t load() const { Lock G(lock); return val; }
+    inline void store(size_t v) { Lock G(lock); val = v; }
+    inline bool cas(size_t expect, size_t desired) { Lock G(lock); if(val!=expect) return false; val = desired; return true; }
+    inline void increment() { Lock G(lock); val++; }
+    inline void decrement() { Lock G(lock); val--; }
+    inline size_t syncLoad() const { return load(); }
+#endif
+};
+
+/* Bounded FIFO with a single consumer, and one or many producers.
+ *
+ * Each cell carries a sequence number which tells producers and the consumer
+ * whose turn it is.  See D. Vyukov's bounded MPMC queue.
+ *  seq==pos          free for the producer of position 'pos'
+ *  seq==pos+1        filled, for the consumer of position 'pos'
+ */
+template<typename T, bool MultiProducer>
+class Ring {
+    EPICS_NOT_COPYABLE(Ring)
+
+    struct Cell {
+        RingIndex seq;
+        T value;
+    };
+
+    const size_t mask;
+    Cell * const cells;
+
+    // pad to keep producer and consumer indices on separate cache lines
+    char pad0[64];
+    RingIndex tail; // next position to fill
+    char pad1[64];
+    RingIndex head; // next position to consume.  Only stored by the consumer
+    char pad2[64];
+
+    RingIndex consumerWaiting, producersWaiting;
+    Event notEmpty, notFull;
+
+    static size_t roundUp(size_t n)
+    {
+        size_t ret = 2u;
+        while(ret<n)
+            ret <<= 1u;
+        return ret;
+    }
+
+    inline bool isFull(size_t pos) const
+    {
+        return cells[pos&mask].seq.load()!=pos;
+    }
+
+    void waitNotFull()
+    {
+        producersWaiting.increment();
+        if(isFull(tail.load()))
+            notFull.wait();
+        producersWaiting.decrement();
+    }
+
+    bool waitNotEmpty(double timeout)
+    {
+        consumerWaiting.increment();
+        bool ret = true;
+        if(empty())
+            ret = timeout<0.0 ? notEmpty.wait() : notEmpty.wait(timeout);
+        consumerWaiting.decrement();
+        return ret;
+    }
+
+public:
+    typedef T value_type;
+
+    explicit Ring(size_t capacity)
+        :mask(roundUp(capacity)-1u)
+        ,cells(new Cell[mask+1u])
+    {
+        for(size_t i=0; i<=mask; i++)
+            cells[i].seq.store(i);
+    }
+
+    ~Ring() { delete[] cells; }
+
+    //! Maximum number of elements.  Requested capacity rounded up to a power of 2.
+    inline size_t capacity() const { return mask+1u; }
+
+    //! Number of elements.  Approximate if other threads are pushing or popping.
+    inline size_t size() const
+    {
+        size_t h = head.load(), t = tail.load();
+        return t>h ? t-h : 0u;
+    }
+
+    //! true if empty.  Approximate if other threads are pushing or popping.
+    inline bool empty() const
+    {
+        size_t pos = head.load();
+        return cells[pos&mask].seq.load()!=pos+1u;
+    }
+
+    /** Add to the tail if not full.  Does not block.
+     * @returns false if full.
+     */
+    bool tryPush(const T& value)
+    {
+        size_t pos = tail.load();
+        Cell *cell;
+
+        if(!MultiProducer) {
+            cell = &cells[pos&mask];
+            if(cell->seq.load()!=pos)
+                return false;
+            tail.store(pos+1u);
+
+        } else {
+            while(true) {
+                cell = &cells[pos&mask];
+                size_t seq = cell->seq.load();
+                if(seq==pos) {
+                    if(tail.cas(pos, pos+1u))
+                        break; // claimed
+                } else if(seq<pos+1u) {
+                    return false; // full (seq==pos+1-capacity)
+                }
+                pos = tail.load();
+            }
+        }
+
+        cell->value = value;
+        cell->seq.store(pos+1u); // publish
+
+        if(consumerWaiting.syncLoad())
+            notEmpty.signal();
+        return true;
+    }
+
+    /** Remove from the head if not empty.  Does not block.
+     * Only one thread may pop.
+     * @returns false if empty.
+     */
+    bool tryPop(T& value)
+    {
+        size_t pos = head.load();
+        Cell& cell = cells[pos&mask];
+        if(cell.seq.load()!=pos+1u)
+            return false;
+
+        std::swap(value, cell.value);
+        cell.value = T();
+        cell.seq.store(pos+mask+1u); // free for producer of the next lap
+        head.store(pos+1u);
+
+        if(producersWaiting.syncLoad())
+            notFull.signal();
+        return true;
+    }
+
+    //! Add to the tail.  Wait while full.
+    void push(const T& value)
+    {
+        bool waited = false;
+        while(!tryPush(value)) {
+            waitNotFull();
+            waited = true;
+        }
+        // Several pops may have been coalesced into one notFull wakeup.
+        // Pass it on to the next blocked producer if space remains.
+        if(waited && producersWaiting.syncLoad() && !isFull(tail.load()))
+            notFull.signal();
+    }
+
+    //! Remove from the head.  Wait while empty.
+    void pop(T& value)
+    {
+        while(!tryPop(value))
+            waitNotEmpty(-1.0);
+    }
+
+    /** Remove from the head.  Wait while empty, for at most 'timeout' seconds.
+     * @returns false if still empty at timeout.
+     */
+    bool pop(T& value, double timeout)
+    {
+        if(tryPop(value))
+            return true;
+        epicsTime deadline(epicsTime::getCurrent()+timeout);
+        while(true) {
+            double remaining = deadline-epicsTime::getCurrent();
+            if(remaining<=0.0 || !waitNotEmpty(remaining))
+                return tryPop(value);
+            if(tryPop(value))
+                return true;
+        }
+    }
+};
+
+} // namespace detail
+
+/** @brief Bounded FIFO queue for passing values from one thread to another.
+ *
+ * tryPush() and tryPop() do not lock.  push() and pop() wait on an Event
+ * when full, or empty.
+ *
+ * Elements are copied in, and swapped out, and so are intended to be cheap to copy,
+ * such as std::tr1::shared_ptr.  The queue may not be copied.
+ *
+ * @code
+ *   typedef std::pair<PVStructurePtr, BitSet::shared_pointer> update_t;
+ *   SPSCRing<update_t> queue(64);
+ *   // producer thread
+ *   queue.push(update_t(value, changed));
+ *   // consumer thread
+ *   update_t update;
+ *   queue.pop(update);
+ * @endcode
+ *
+ * @version Added after 8.0.0
+ */
+template<typename T>
+class SPSCRing : public detail::Ring<T, false> {
+public:
+    //! @param capacity Rounded up to a power of 2
+    explicit SPSCRing(size_t capacity) :detail::Ring<T, false>(capacity) {}
+};
+
+/** @brief Bounded FIFO queue for passing values from many threads to one thread.
+ *
+ * As SPSCRing, except that any number of threads may push concurrently.
+ * The order of elements pushed by any one thread is preserved.
+ *
+ * @version Added after 8.0.0
+ */
+template<typename T>
+class MPSCRing : public detail::Ring<T, true> {
+public:
+    //! @param capacity Rounded up to a power of 2
+    explicit MPSCRing(size_t capacity) :detail::Ring<T, true>(capacity) {}
+};
+
+}} // namespace epics::pvData
+
+#endif // RINGBUFFER_H
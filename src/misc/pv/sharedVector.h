@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <stdexcept>
 #include <iterator>
+#include <new>
 
 #if __cplusplus>=201103L
 #  include <initializer_list>
@@ -20,6 +21,8 @@
 #include "pv/sharedPtr.h"
 #include "pv/pvIntrospect.h"
 #include "pv/typeCast.h"
+#include "pv/allocStats.h"
+#include "pv/arrayAllocator.h"
 #include "pv/templateMeta.h"
 
 namespace epics { namespace pvData {
@@ -35,6 +38,166 @@ namespace detail {
     template<typename E>
     struct default_array_deleter {void operator()(E a){delete[] a;}};
 
+    template<int> struct alloc_kind_enable { typedef void type; };
+
+    // AllocKind for arrays of E
+    template<typename E, class Enable = void>
+    struct alloc_kind { enum {value=::epics::detail::allocOther}; };
+    template<typename E>
+    struct alloc_kind<E, typename alloc_kind_enable<ScalarTypeID<E>::value>::type>
+    { enum {value=ScalarTypeID<E>::value}; };
+
+    template<typename E>
+    struct counted_array_deleter {
+        size_t bytes;
+        explicit counted_array_deleter(size_t bytes) :bytes(bytes) {}
+        void operator()(E* a) {
+            ::epics::detail::allocSub((::epics::detail::AllocKind)alloc_kind<E>::value, bytes);
+            delete[] a;
+        }
+    };
+
+    // Destroys, and returns to its ArrayAllocator, an array of E
+    template<typename E>
+    struct allocator_array_deleter {
+        ArrayAllocator::shared_pointer allocator;
+        size_t count;
+        bool counted;
+        allocator_array_deleter(const ArrayAllocator::shared_pointer& allocator, size_t count, bool counted)
+            :allocator(allocator), count(count), counted(counted) {}
+        void operator()(E* a) {
+            for(size_t i=count; i; i--)
+                a[i-1].~E();
+            if(counted)
+                ::epics::detail::allocSub((::epics::detail::AllocKind)alloc_kind<E>::value, count*sizeof(E));
+            allocator->deallocate(a, count*sizeof(E));
+        }
+    };
+
+#if __cplusplus>=201103L && !defined(SHARED_FROM_MANUAL) && !defined(DEBUG_SHARED_PTR)
+#  define PVD_SHARED_VECTOR_SINGLE_ALLOC
+    /* Single allocation of shared_ptr control block and array.
+     *
+     * allocate_shared() is given an allocator which allocates extra space
+     * after the control block, which holds an inline_array_holder.
+     * The array is placed in this extra space, and destroyed by ~inline_array_holder().
+     */
+    template<typename E>
+    struct inline_array_holder {
+        E *elems;
+        size_t count;
+        bool counted;
+        inline_array_holder() :elems(0), count(0u), counted(false) {}
+        ~inline_array_holder() {
+            for(size_t i=count; i; i--)
+                elems[i-1].~E();
+            if(counted)
+                ::epics::detail::allocSub((::epics::detail::AllocKind)alloc_kind<E>::value, count*sizeof(E));
+        }
+    };
+
+    template<typename T>
+    struct inline_array_alloc {
+        typedef T value_type;
+        // offset of extra space, aligned as for new[]
+        enum {align = 16};
+        size_t extra;
+        void **payload;
+        inline_array_alloc(size_t extra, void **payload) :extra(extra), payload(payload) {}
+        template<typename U>
+        inline_array_alloc(const inline_array_alloc<U>& o) :extra(o.extra), payload(o.payload) {}
+        static size_t offset() { return (sizeof(T)+align-1u)&~size_t(align-1u); }
+        T* allocate(size_t n) {
+            assert(n==1u);
+            char *raw = static_cast<char*>(::operator new(offset()+extra));
+            *payload = raw+offset();
+            return reinterpret_cast<T*>(raw);
+        }
+        void deallocate(T* p, size_t) { ::operator delete(p); }
+        template<typename U>
+        bool operator==(const inline_array_alloc<U>& o) const { return payload==o.payload; }
+        template<typename U>
+        bool operator!=(const inline_array_alloc<U>& o) const { return payload!=o.payload; }
+    };
+
+    //! Largest number of elements allocated together with the shared_ptr control block
+    enum {single_alloc_max = 64};
+
+    template<typename E>
+    std::tr1::shared_ptr<E> allocate_inline_array(size_t n, bool counted)
+    {
+        typedef inline_array_holder<E> holder_t;
+        if(n > (((size_t)-1)-1024u)/sizeof(E))
+            throw std::bad_alloc();
+        void *payload = 0;
+        std::tr1::shared_ptr<holder_t> H(std::allocate_shared<holder_t>(inline_array_alloc<holder_t>(n*sizeof(E), &payload)));
+        E *raw = static_cast<E*>(payload);
+        H->elems = raw;
+        size_t i=0;
+        try {
+            // default initialize, as new[] would
+            for(; i<n; i++)
+                new (raw+i) E;
+        } catch(...) {
+            H->count = i; // destroy only those constructed
+            throw;
+        }
+        H->count = n;
+        if(counted) {
+            H->counted = true;
+            ::epics::detail::allocAdd((::epics::detail::AllocKind)alloc_kind<E>::value, n*sizeof(E));
+        }
+        return std::tr1::shared_ptr<E>(H, raw);
+    }
+#endif
+
+    /** Allocate an array of n elements, counted if allocStatsEnabled()
+     *
+     * From the given allocator, or else ArrayAllocator::current(), or else with new[],
+     * or, for arrays of up to single_alloc_max elements, with the shared_ptr control block
+     * when PVD_SHARED_VECTOR_SINGLE_ALLOC is defined.
+     */
+    template<typename E>
+    std::tr1::shared_ptr<E> allocate_array(size_t n,
+                                           const ArrayAllocator::shared_pointer& allocator = ArrayAllocator::shared_pointer())
+    {
+        const bool counted = ::epics::allocStatsEnabled();
+        const ArrayAllocator::shared_pointer A(allocator ? allocator : ArrayAllocator::current());
+
+        if(!A) {
+#ifdef PVD_SHARED_VECTOR_SINGLE_ALLOC
+            // Only for small arrays, as the array is not released until the last
+            // weak_ptr, as well as the last shared_ptr, is released.
+            if(n <= size_t(single_alloc_max))
+                return allocate_inline_array<E>(n, counted);
+#endif
+            E *raw = new E[n];
+            if(!counted)
+                return std::tr1::shared_ptr<E>(raw, default_array_deleter<E*>());
+            size_t bytes = n*sizeof(E);
+            ::epics::detail::allocAdd((::epics::detail::AllocKind)alloc_kind<E>::value, bytes);
+            return std::tr1::shared_ptr<E>(raw, counted_array_deleter<E>(bytes));
+        }
+
+        if(n > ((size_t)-1)/sizeof(E))
+            throw std::bad_alloc();
+        E *raw = static_cast<E*>(A->allocate(n*sizeof(E)));
+        size_t i=0;
+        try {
+            // default initialize, as new[] would
+            for(; i<n; i++)
+                new (raw+i) E;
+        } catch(...) {
+            while(i)
+                raw[--i].~E();
+            A->deallocate(raw, n*sizeof(E));
+            throw;
+        }
+        if(counted)
+            ::epics::detail::allocAdd((::epics::detail::AllocKind)alloc_kind<E>::value, n*sizeof(E));
+        return std::tr1::shared_ptr<E>(raw, allocator_array_deleter<E>(A, n, counted));
+    }
+
     // How values should be passed as arguments to shared_vector methods
     // really should use boost::call_traits
     template<typename T> struct call_with { typedef T type; };
@@ -318,21 +481,31 @@ public:
 #if __cplusplus>=201103L
     template<typename A>
     shared_vector(std::initializer_list<A> L)
-        :base_t(new _E_non_const[L.size()], 0, L.size())
+        :base_t(detail::allocate_array<_E_non_const>(L.size()), 0, L.size())
     {
         _E_non_const *raw = const_cast<_E_non_const*>(data());
         std::copy(L.begin(), L.end(), raw);
     }
 #endif
 
-    //! @brief Allocate (with new[]) a new vector of size c
+    //! @brief Allocate (with new[], or ArrayAllocator::current() ) a new vector of size c
     explicit shared_vector(size_t c)
-        :base_t(new _E_non_const[c], 0, c)
+        :base_t(detail::allocate_array<_E_non_const>(c), 0, c)
+    {}
+
+    /** @brief Allocate a new vector of size c from the given allocator
+     *
+     * @param c Number of elements
+     * @param allocator Source of memory.  If empty, as shared_vector(size_t).
+     * @version Added after 8.0.0
+     */
+    shared_vector(size_t c, const ArrayAllocator::shared_pointer& allocator)
+        :base_t(detail::allocate_array<_E_non_const>(c, allocator), 0, c)
     {}
 
-    //! @brief Allocate (with new[]) a new vector of size c and fill with value e
+    //! @brief Allocate (with new[], or ArrayAllocator::current() ) a new vector of size c and fill with value e
     shared_vector(size_t c, param_type e)
-        :base_t(new _E_non_const[c], 0, c)
+        :base_t(detail::allocate_array<_E_non_const>(c), 0, c)
     {
         std::fill_n((_E_non_const*)this->m_sdata.get(), this->m_count, e);
     }
@@ -428,17 +601,25 @@ public:
     void reserve(size_t i) {
         if(this->unique() && i<=this->m_total)
             return;
+        reserve(i, ArrayAllocator::shared_pointer());
+    }
+
+    /** @brief Set array capacity, allocating from the given allocator
+     *
+     * As reserve(size_t), except that the array is always re-allocated.
+     * eg. to move existing elements into aligned memory.
+     *
+     * @param i New capacity
+     * @param allocator Source of memory.  If empty, new[] or ArrayAllocator::current().
+     * @version Added after 8.0.0
+     */
+    void reserve(size_t i, const ArrayAllocator::shared_pointer& allocator) {
         size_t new_count = this->m_count;
         if(new_count > i)
             new_count = i;
-        _E_non_const* temp=new _E_non_const[i];
-        try{
-            std::copy(begin(), begin()+new_count, temp);
-            this->m_sdata.reset(temp, detail::default_array_deleter<E*>());
-        }catch(...){
-            delete[] temp;
-            throw;
-        }
+        std::tr1::shared_ptr<_E_non_const> temp(detail::allocate_array<_E_non_const>(i, allocator));
+        std::copy(begin(), begin()+new_count, temp.get());
+        this->m_sdata = temp;
         this->m_offset = 0;
         this->m_count = new_count;
         this->m_total = i;
@@ -471,21 +652,16 @@ public:
         size_t new_total = this->m_total;
         if(new_total < i)
             new_total = i;
-        _E_non_const* temp=new _E_non_const[new_total];
-        try{
-            size_t n = this->size();
-            if(n > i)
-                n = i;
-            // Copy as much as possible from old,
-            // remaining elements are uninitialized.
-            std::copy(begin(),
-                      begin()+n,
-                      temp);
-            this->m_sdata.reset(temp, detail::default_array_deleter<pointer>());
-        }catch(...){
-            delete[] temp;
-            throw;
-        }
+        std::tr1::shared_ptr<_E_non_const> temp(detail::allocate_array<_E_non_const>(new_total));
+        size_t n = this->size();
+        if(n > i)
+            n = i;
+        // Copy as much as possible from old,
+        // remaining elements are uninitialized.
+        std::copy(begin(),
+                  begin()+n,
+                  temp.get());
+        this->m_sdata = temp;
         this->m_offset= 0;
         this->m_count = i;
         this->m_total = new_total;
@@ -503,6 +679,36 @@ public:
         }
     }
 
+    /** @brief Grow or shrink array, when all elements will then be overwritten.
+     *
+     * As resize(size_t), except that existing elements are not copied if
+     * a re-allocation is needed, so the values of all elements are unspecified.
+     * Elements of types with a default constructor are default constructed,
+     * others (eg. double) are left uninitialized.
+     *
+     * Like resize(), array data will be uniquely owned by this instance.
+     *
+     @code
+       shared_vector<double> arr;
+       arr.resize_uninitialized(N);
+       for(size_t i=0; i<N; i++)
+           arr[i] = ...;
+     @endcode
+     *
+     * @throws std::bad_alloc if requested allocation can not be made
+     * @version Added after 8.0.0
+     */
+    void resize_uninitialized(size_t i) {
+        if(this->m_sdata && this->m_sdata.use_count()==1 && i<=this->m_total) {
+            this->m_count = i;
+            return;
+        }
+        this->m_sdata = detail::allocate_array<_E_non_const>(i);
+        this->m_offset= 0;
+        this->m_count = i;
+        this->m_total = i;
+    }
+
     /** @brief Ensure (by copying) that this shared_vector is the sole
      *  owner of the data array.
      *
@@ -527,16 +733,11 @@ public:
         if(this->unique())
             return;
         // at this point we know that !!m_sdata, so get()!=NULL
-        _E_non_const *d = new _E_non_const[this->m_total];
-        try {
-            std::copy(this->m_sdata.get()+this->m_offset,
-                      this->m_sdata.get()+this->m_offset+this->m_count,
-                      d);
-        }catch(...){
-            delete[] d;
-            throw;
-        }
-        this->m_sdata.reset(d, detail::default_array_deleter<E*>());
+        std::tr1::shared_ptr<_E_non_const> d(detail::allocate_array<_E_non_const>(this->m_total));
+        std::copy(this->m_sdata.get()+this->m_offset,
+                  this->m_sdata.get()+this->m_offset+this->m_count,
+                  d.get());
+        this->m_sdata = d;
         this->m_offset=0;
     }
 
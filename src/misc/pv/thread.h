@@ -12,6 +12,8 @@
 #include <memory>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 #if __cplusplus>=201103L
 #include <functional>
@@ -58,6 +60,59 @@ struct MethRunner : public epicsThreadRunable
 };
 } // namespace detail
 
+/**
+ * @brief A set of CPUs on which a thread may run.
+ *
+ * Applied by a thread to itself.  Only implemented for Linux.
+ * Elsewhere apply() does nothing.
+ *
+ @code
+    // CPUs of the NUMA node where eth0 is attached
+    ThreadAffinity near;
+    int node = ThreadAffinity::interfaceNumaNode("eth0");
+    if(node>=0)
+        near.numaNode(node);
+    Thread worker(Thread::Config(&X, &bar::meth)
+                  .affinity(near)
+                  .name("worker"));
+ @endcode
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass ThreadAffinity {
+    std::vector<unsigned> p_cpus;
+public:
+    //! Empty set.  Threads may run on any CPU.
+    ThreadAffinity() {}
+
+    /** Parse a Linux style CPU list.  eg. "0-3,8,10-11"
+     * @throws std::invalid_argument for invalid syntax
+     */
+    static ThreadAffinity parse(const std::string& list);
+
+    //! Add one CPU number
+    ThreadAffinity& cpu(unsigned c);
+    /** Add all CPUs of a NUMA node, as listed in /sys/devices/system/node/
+     *
+     * Adds nothing if the node does not exist, or NUMA information is not available.
+     */
+    ThreadAffinity& numaNode(unsigned node);
+
+    /** NUMA node of the device behind a network interface
+     * @returns -1 if not known
+     */
+    static int interfaceNumaNode(const std::string& ifname);
+
+    //! CPU numbers in increasing order
+    const std::vector<unsigned>& cpus() const { return p_cpus; }
+    bool empty() const { return p_cpus.empty(); }
+
+    /** Restrict the calling thread to this set.
+     * @returns false if empty, not supported, or rejected by the OS.
+     */
+    bool apply() const;
+};
+
 /**
  * @brief C++ wrapper for epicsThread from EPICS base.
  *
@@ -77,6 +132,7 @@ public:
      *  priority: epicsThreadPriorityLow (aka epics::pvData::lowestPriority)
      *  stack size: epicsThreadStackSmall
      *  auto start: true
+     *  affinity: none (any CPU)
      *  runner: nil (must be set explictly)
      *
      @code
@@ -97,6 +153,7 @@ public:
         unsigned int p_prio, p_stack;
         std::ostringstream p_strm;
         bool p_autostart;
+        ThreadAffinity p_affinity;
         Runnable *p_runner;
         typedef epics::auto_ptr<Runnable> p_owned_runner_t;
         p_owned_runner_t p_owned_runner;
@@ -118,6 +175,12 @@ public:
         Config& prio(unsigned int p);
         Config& stack(epicsThreadStackSizeClass s);
         Config& autostart(bool a);
+        //! Thread restricts itself to these CPUs before running.  @version Added after 8.0.0
+        Config& affinity(const ThreadAffinity& a);
+        //! Add one CPU to the affinity set.  @version Added after 8.0.0
+        Config& cpu(unsigned c);
+        //! Add the CPUs of a NUMA node to the affinity set.  @version Added after 8.0.0
+        Config& numaNode(unsigned node);
 
         //! Thread will execute Runnable::run()
         Config& run(Runnable* r);
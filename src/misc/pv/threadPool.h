@@ -0,0 +1,135 @@
+/* threadPool.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <string>
+#include <vector>
+
+#if __cplusplus>=201103L
+#include <functional>
+#endif
+
+#include <shareLib.h>
+
+#include <pv/sharedPtr.h>
+#include <pv/noDefaultMethods.h>
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+
+namespace epics { namespace pvData {
+
+/** @brief A pool of worker threads which run queued tasks.
+ *
+ * Each worker has its own queue.  Tasks submitted by a worker are
+ * added to its own queue, and run most recent first.  An idle worker
+ * takes (steals) the oldest task from the queue of another worker.
+ * Tasks submitted by other threads are spread across the worker queues.
+ *
+ * @code
+ *   ThreadPool::shared_pointer pool(new ThreadPool(ThreadPool::Config()
+ *                                                  .workers(4)
+ *                                                  .prio(middlePriority)
+ *                                                  .name("mypool")));
+ *   struct MyTask : public Runnable { virtual void run() { ... } };
+ *   pool->submit(ThreadPool::task_t(new MyTask));
+ *   pool->drain();
+ * @endcode
+ *
+ * Exceptions thrown by a task are caught and printed.
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass ThreadPool {
+    EPICS_NOT_COPYABLE(ThreadPool)
+public:
+    POINTER_DEFINITIONS(ThreadPool);
+
+    typedef std::tr1::shared_ptr<Runnable> task_t;
+
+    //! ThreadPool construction options
+    class epicsShareClass Config {
+        size_t p_workers, p_maxQueue;
+        unsigned int p_prio;
+        std::string p_name;
+        friend class ThreadPool;
+    public:
+        /** Defaults:
+         *  workers: number of CPU cores
+         *  maxQueue: 0 (unbounded)
+         *  priority: epicsThreadPriorityLow (aka epics::pvData::lowestPriority)
+         *  name: "ThreadPool"
+         */
+        Config();
+        //! Number of worker threads
+        Config& workers(size_t n) { p_workers = n; return *this; }
+        //! Limit the number of tasks waiting to run.  Zero for no limit.
+        Config& maxQueue(size_t n) { p_maxQueue = n; return *this; }
+        //! Priority of worker threads
+        Config& prio(unsigned int p) { p_prio = p; return *this; }
+        //! Worker threads are named name-N
+        Config& name(const std::string& n) { p_name = n; return *this; }
+    };
+
+    explicit ThreadPool(const Config& conf = Config());
+    //! Calls shutdown(true)
+    ~ThreadPool();
+
+    /** Queue a task to be run by some worker.
+     *
+     * If a queue limit is set and reached, wait for space.
+     * Except when called from a worker, which never waits.
+     *
+     * @returns false if the pool is shut down, and the task will not run.
+     */
+    bool submit(const task_t& task);
+    //! As submit(), but return false instead of waiting when the queue limit is reached.
+    bool trySubmit(const task_t& task);
+#if __cplusplus>=201103L
+    bool submit(std::function<void()>&& fn);
+#endif
+
+    /** Wait until all queued tasks have run.
+     * Must not be called from a worker.
+     */
+    void drain();
+
+    /** Stop accepting tasks, then stop and join the workers.
+     *
+     * @param drain If true, run all queued tasks first.  If false, discard any tasks not yet started.
+     * Must not be called from a worker.
+     */
+    void shutdown(bool drain = true);
+
+    //! Number of worker threads
+    size_t workers() const;
+    //! Number of tasks waiting to run
+    size_t queued() const;
+
+private:
+    struct Worker;
+
+    Worker* current() const;
+    bool enqueue(const task_t& task, bool wait);
+    bool take(Worker* self, task_t& task);
+    void run(Worker* self);
+
+    mutable Mutex lock;
+    // guarded by lock
+    size_t nqueued, nrunning, nextWorker,
+           nblocked; // submitters waiting for spaceAvailable
+    bool accepting, running;
+    std::vector<Worker*> idle;
+
+    const size_t maxQueue;
+    Event spaceAvailable, drained;
+    std::vector<Worker*> pool;
+};
+
+}}
+
+#endif // THREADPOOL_H
@@ -9,7 +9,8 @@
 #ifndef TIMER_H
 #define TIMER_H
 #include <memory>
-#include <list>
+#include <vector>
+#include <deque>
 
 #include <stddef.h>
 #include <stdlib.h>
@@ -57,9 +58,16 @@ public:
      */
     virtual void timerStopped() = 0;
 private:
-    epicsTime timeToRun;
+    epicsTime timeToRun; // nominal rounded up by slack
+    epicsTime nominal;
     double period;
+    double slack;
+    int catchUp; // Timer::CatchUp
     bool onList;
+    size_t heapIndex; // position in Timer::queue when onList
+    uint64 order; // orders callbacks with equal timeToRun by scheduling
+    bool busy;  // waiting for, or running on, a worker
+    bool rerun; // expired again while busy
     friend class Timer;
     struct IncreasingTime;
 };
@@ -71,11 +79,45 @@ private:
 class epicsShareClass Timer : private Runnable {
 public:
     POINTER_DEFINITIONS(Timer);
+    /** What a periodic callback does when it falls behind,
+     *  eg. when callback() runs for longer than the period.
+     * @version Added after 8.0.0
+     */
+    enum CatchUp {
+        //! Run once for each missed period, without delay.  Keeps the nominal schedule.  (default)
+        burst,
+        //! Run once, then continue from the next nominal time which is not past.
+        skipMissed,
+        //! Run again one period after each callback() returns.  The schedule drifts.
+        fixedDelay
+    };
     /** Create a new timer queue
      * @param threadName name for the timer thread.
      * @param priority thread priority
      */
     Timer(std::string threadName, ThreadPriority priority);
+    /** Create a new timer queue whose callbacks are run by a pool of worker threads.
+     *
+     * The timer thread only waits for expiry.  So a slow callback delays only
+     * those callbacks waiting for a free worker.
+     * Different callbacks may run concurrently.
+     * A single TimerCallback is never run concurrently with itself.
+     * A periodic callback is re-scheduled after its callback() returns.
+     *
+     * @param threadName name for the timer thread.  Workers are named threadName-N
+     * @param priority priority of timer and worker threads
+     * @param nworkers Number of worker threads.  Zero runs callbacks on the timer thread.
+     * @version Added after 8.0.0
+     */
+    Timer(std::string threadName, ThreadPriority priority, size_t nworkers);
+    /** As Timer(std::string, ThreadPriority, size_t), with the timer and worker threads
+     * restricted to some CPUs.
+     *
+     * @param affinity CPUs for the timer and worker threads.
+     * @version Added after 8.0.0
+     */
+    Timer(std::string threadName, ThreadPriority priority, size_t nworkers,
+          const ThreadAffinity& affinity);
     virtual ~Timer();
     //! Prevent new callbacks from being scheduled, and cancel pending callbacks
     void close();
@@ -87,6 +129,22 @@ public:
     void scheduleAfterDelay(
         TimerCallbackPtr const &timerCallback,
         double delay);
+    /**
+     * schedule a callback after a delay, allowing it to run late.
+     *
+     * The expiry time is rounded up to a multiple of the largest power of two
+     * seconds not greater than 'slack'.  So callbacks scheduled with similar times and
+     * slack expire together, with a single wakeup of the timer thread.
+     *
+     * @param timerCallback the timerCallback instance.
+     * @param delay number of seconds before calling callback.
+     * @param slack maximum number of seconds the callback may be delayed.
+     * @version Added after 8.0.0
+     */
+    void scheduleAfterDelay(
+        TimerCallbackPtr const &timerCallback,
+        double delay,
+        double slack);
     /**
      * schedule a periodic callback.`
      * @param timerCallback the timerCallback instance.
@@ -97,6 +155,25 @@ public:
         TimerCallbackPtr const &timerCallback,
         double delay,
         double period);
+    /**
+     * schedule a periodic callback with slack and catch up policy.
+     *
+     * Slack is applied to each period as for scheduleAfterDelay(TimerCallbackPtr const&, double, double).
+     * It does not accumulate, as each period is counted from the nominal (un-rounded) time.
+     *
+     * @param timerCallback the timerCallback instance.
+     * @param delay number of seconds before first callback.
+     * @param period time in seconds between each callback.
+     * @param slack maximum number of seconds each callback may be delayed.
+     * @param catchUp what to do when a callback falls behind.
+     * @version Added after 8.0.0
+     */
+    void schedulePeriodic(
+        TimerCallbackPtr const &timerCallback,
+        double delay,
+        double period,
+        double slack,
+        CatchUp catchUp = burst);
     /**
      * cancel a callback.
      * @param timerCallback the timerCallback to cancel.
@@ -117,17 +194,36 @@ public:
 
 private:
     virtual void run();
+    void runWorker();
+    void startWorkers(const std::string& threadName, ThreadPriority priority);
 
     // call with mutex held
     void addElement(TimerCallbackPtr const &timerCallback);
+    void reschedule(TimerCallbackPtr const &timerCallback);
+    TimerCallbackPtr removeElement(size_t index);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
 
-    typedef std::list<TimerCallbackPtr> queue_t;
+    // binary heap, earliest timeToRun at front.
+    // O(log(N)) to add or cancel.
+    typedef std::vector<TimerCallbackPtr> queue_t;
 
     mutable Mutex mutex;
     queue_t queue;
+    uint64 nextOrder;
     Event waitForWork;
     bool waiting;
     bool alive;
+
+    // worker pool.  ready holds expired callbacks, in expiry order
+    const size_t poolSize;
+    std::deque<TimerCallbackPtr> ready;
+    Event workReady;
+    bool workersRun;
+    std::vector<Thread*> workers;
+
+    // applied by the timer thread to itself.  Must be initialized before 'thread'
+    const ThreadAffinity affinity;
     Thread thread;
 };
 
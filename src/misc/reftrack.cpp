@@ -22,6 +22,7 @@
 #include <pv/pvdVersion.h>
 #include <pv/sharedPtr.h>
 #include "pv/reftrack.h"
+#include "pv/latency.h"
 
 namespace {
 
@@ -37,9 +38,27 @@ size_t readref(const size_t *ref)
 typedef epicsGuard<epicsMutex> Guard;
 typedef epicsGuardRelease<epicsMutex> UnGuard;
 
+// one of plain or sharded is set
+struct counter_t {
+    const size_t *plain;
+    const epics::ShardedCounter *sharded;
+    counter_t() :plain(0), sharded(0) {}
+    bool operator==(const counter_t& o) const { return plain==o.plain && sharded==o.sharded; }
+    size_t read() const
+    {
+        if(sharded)
+            return sharded->get();
+#ifdef REFTRACK_USE_ATOMIC
+        return epics::atomic::get(*plain);
+#else
+        return readref(plain);
+#endif
+    }
+};
+
 struct refgbl_t {
     epicsMutex lock;
-    typedef std::map<std::string, const size_t*> counters_t;
+    typedef std::map<std::string, counter_t> counters_t;
     counters_t counters;
 } *refgbl;
 
@@ -61,18 +80,14 @@ void refgbl_setup()
         throw std::runtime_error("Failed to initialize global ref. counter registry");
 }
 
-} // namespace
-
-namespace epics {
-
-void registerRefCounter(const char *name, const size_t* counter)
+void registerCounter(const char *name, const counter_t& counter)
 {
     refgbl_setup();
     Guard G(refgbl->lock);
     refgbl->counters[name] = counter;
 }
 
-void unregisterRefCounter(const char *name, const size_t* counter)
+void unregisterCounter(const char *name, const counter_t& counter)
 {
     refgbl_setup();
     Guard G(refgbl->lock);
@@ -81,6 +96,104 @@ void unregisterRefCounter(const char *name, const size_t* counter)
         refgbl->counters.erase(it);
 }
 
+// assigns shards to threads round robin
+size_t nextShard;
+
+unsigned assignShard()
+{
+#ifdef REFTRACK_USE_ATOMIC
+    return unsigned(epics::atomic::increment(nextShard)%epics::ShardedCounter::nshards);
+#else
+    return unsigned(nextShard++%epics::ShardedCounter::nshards);
+#endif
+}
+
+} // namespace
+
+namespace epics {
+
+namespace detail {
+unsigned refShard()
+{
+#if __cplusplus>=201103L
+    static thread_local unsigned shard = assignShard();
+    return shard;
+#elif defined(__GNUC__)
+    static __thread unsigned shard; // shard+1, or zero if not assigned
+    if(!shard)
+        shard = assignShard()+1u;
+    return shard-1u;
+#else
+    // no thread local storage.  spread threads by id
+    size_t id = size_t(epicsThreadGetIdSelf());
+    return unsigned((id ^ (id>>8u) ^ (id>>16u))%ShardedCounter::nshards);
+#endif
+}
+} // namespace detail
+
+void ShardedCounter::setTotal(size_t *total)
+{
+    this->total = total;
+}
+
+void ShardedCounter::flush(Shard& S)
+{
+#ifdef REFTRACK_USE_ATOMIC
+    // move the shard count into the total.  If the shard changes concurrently, the next update will flush.
+    size_t val = atomic::get(S.count);
+    if(atomic::compareAndSwap(S.count, val, size_t(0u))==val)
+        atomic::add(*total, val);
+#endif
+}
+
+size_t ShardedCounter::get() const
+{
+    size_t sum = 0u;
+    for(unsigned i=0; i<nshards; i++) {
+#ifdef REFTRACK_USE_ATOMIC
+        sum += atomic::get(shards[i].count);
+#else
+        sum += readref(&shards[i].count);
+#endif
+    }
+    if(total) {
+#ifdef REFTRACK_USE_ATOMIC
+        sum += atomic::get(*total);
+#else
+        sum += readref(total);
+#endif
+    }
+    return sum;
+}
+
+void registerRefCounter(const char *name, const size_t* counter)
+{
+    counter_t C;
+    C.plain = counter;
+    registerCounter(name, C);
+}
+
+void registerRefCounter(const char *name, const ShardedCounter* counter)
+{
+    counter_t C;
+    C.sharded = counter;
+    registerCounter(name, C);
+}
+
+void unregisterRefCounter(const char *name, const size_t* counter)
+{
+    counter_t C;
+    C.plain = counter;
+    unregisterCounter(name, C);
+}
+
+void unregisterRefCounter(const char *name, const ShardedCounter* counter)
+{
+    counter_t C;
+    C.sharded = counter;
+    unregisterCounter(name, C);
+}
+
 size_t readRefCounter(const char *name)
 {
     refgbl_setup();
@@ -88,11 +201,7 @@ size_t readRefCounter(const char *name)
     refgbl_t::counters_t::iterator it(refgbl->counters.find(name));
     if(it==refgbl->counters.end())
         return 0;
-#ifdef REFTRACK_USE_ATOMIC
-    return atomic::get(*it->second);
-#else
-    return readref(it->second);
-#endif
+    return it->second.read();
 }
 
 const RefSnapshot::Count&
@@ -119,11 +228,7 @@ void RefSnapshot::update()
                                             end=counters.end();
         it!=end; ++it)
     {
-#ifdef REFTRACK_USE_ATOMIC
-        size_t cnt = atomic::get(*it->second);
-#else
-        size_t cnt = readref(it->second);
-#endif
+        size_t cnt = it->second.read();
 
         counts[it->first] = Count(cnt, 0);
     }
@@ -176,6 +281,7 @@ struct RefMonitor::Impl : public epicsThreadRunable
     epicsMutex lock;
     epicsEvent wakeup;
     RefSnapshot prev;
+    LatencySnapshot prevLatency;
     bool done;
     double period;
     Impl(RefMonitor* owner) :owner(*owner), done(false), period(10.0) {}
@@ -186,16 +292,21 @@ struct RefMonitor::Impl : public epicsThreadRunable
         Guard G(lock);
         while(!done) {
             RefSnapshot current, P;
+            LatencySnapshot currentLatency, PL;
             P = prev; // copy
+            PL = prevLatency;
             {
                 UnGuard U(G);
 
                 current.update();
+                currentLatency.update();
 
                 owner.show(current-P);
+                owner.showLatency(currentLatency-PL);
             }
 
             prev.swap(current);
+            prevLatency.swap(currentLatency);
 
             {
                 UnGuard U(G);
@@ -261,6 +372,14 @@ void RefMonitor::current()
     }
 
     show(current-P, true);
+
+    LatencySnapshot currentLatency, PL;
+    currentLatency.update();
+    {
+        Guard G(impl->lock);
+        PL = impl->prevLatency; // copy
+    }
+    showLatency(currentLatency-PL);
 }
 
 void RefMonitor::show(const RefSnapshot &snap, bool complete)
@@ -278,6 +397,17 @@ void RefMonitor::show(const RefSnapshot &snap, bool complete)
     }
 }
 
+void RefMonitor::showLatency(const LatencySnapshot &snap)
+{
+    bool any = false;
+    for(LatencySnapshot::const_iterator it = snap.begin(), end = snap.end(); !any && it!=end; ++it)
+        any = it->second.count!=0u;
+    if(!any)
+        return;
+
+    std::cerr<<"Latency\n"<<snap;
+}
+
 } // namespace epics
 
 
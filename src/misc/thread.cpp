@@ -4,6 +4,16 @@
  * found in the file LICENSE that is included with the distribution
  */
 
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#if defined(__linux__)
+#  include <pthread.h>
+#  include <sched.h>
+#endif
+
 #include <epicsThread.h>
 #define epicsExportSharedSymbols
 #include <pv/thread.h>
@@ -37,13 +47,133 @@ struct BindRunner : public epicsThreadRunable
     }
 };
 #endif
+
+// applies affinity in the new thread, then runs the real runner
+struct AffinityRunner : public epicsThreadRunable
+{
+    ThreadAffinity affinity;
+    Runnable *runner;
+    epics::auto_ptr<Runnable> owned;
+    AffinityRunner(const ThreadAffinity& a, Runnable *r) :affinity(a), runner(r) {}
+    virtual ~AffinityRunner() {}
+    virtual void run()
+    {
+#if defined(__linux__)
+        if(!affinity.apply())
+            std::cerr<<"Warning: unable to set CPU affinity of thread "
+                     <<epicsThreadGetNameSelf()<<"\n";
+#else
+        affinity.apply(); // no-op
+#endif
+        runner->run();
+    }
+};
 } // detail
 
+namespace {
+// sanity limit for parse()
+const unsigned maxCPU = 1u<<16u;
+}
+
+ThreadAffinity ThreadAffinity::parse(const std::string& list)
+{
+    ThreadAffinity ret;
+    std::istringstream strm(list);
+    std::string part;
+    while(std::getline(strm, part, ',')) {
+        // trim whitespace, including a trailing newline from sysfs
+        size_t first = part.find_first_not_of(" \t\n"),
+               last = part.find_last_not_of(" \t\n");
+        if(first==std::string::npos) {
+            if(list.find_first_not_of(" \t\n")==std::string::npos)
+                break; // entirely empty list
+            throw std::invalid_argument("Empty entry in CPU list \""+list+"\"");
+        }
+        part = part.substr(first, last-first+1);
+
+        std::istringstream range(part);
+        unsigned lo, hi;
+        char dash;
+        if(part[0]<'0' || part[0]>'9' || !(range>>lo))
+            throw std::invalid_argument("Invalid CPU list \""+list+"\"");
+        hi = lo;
+        if(range>>dash) {
+            if(dash!='-' || range.peek()<'0' || range.peek()>'9' || !(range>>hi) || hi<lo)
+                throw std::invalid_argument("Invalid CPU list \""+list+"\"");
+        }
+        if(hi>=maxCPU)
+            throw std::invalid_argument("CPU number out of range in \""+list+"\"");
+        if(!range.eof() && range.peek()!=EOF)
+            throw std::invalid_argument("Invalid CPU list \""+list+"\"");
+        for(unsigned c=lo; c<=hi; c++)
+            ret.cpu(c);
+    }
+    return ret;
+}
+
+ThreadAffinity& ThreadAffinity::cpu(unsigned c)
+{
+    std::vector<unsigned>::iterator it(std::lower_bound(p_cpus.begin(), p_cpus.end(), c));
+    if(it==p_cpus.end() || *it!=c)
+        p_cpus.insert(it, c);
+    return *this;
+}
+
+ThreadAffinity& ThreadAffinity::numaNode(unsigned node)
+{
+    std::ostringstream name;
+    name<<"/sys/devices/system/node/node"<<node<<"/cpulist";
+    std::ifstream strm(name.str().c_str());
+    std::string list;
+    if(strm && std::getline(strm, list)) {
+        try {
+            ThreadAffinity cpus(parse(list));
+            for(size_t i=0; i<cpus.p_cpus.size(); i++)
+                cpu(cpus.p_cpus[i]);
+        } catch(std::invalid_argument&) {
+            // unexpected format, treat as unknown
+        }
+    }
+    return *this;
+}
+
+int ThreadAffinity::interfaceNumaNode(const std::string& ifname)
+{
+    std::ifstream strm(("/sys/class/net/"+ifname+"/device/numa_node").c_str());
+    int node = -1;
+    if(!(strm>>node))
+        node = -1;
+    return node;
+}
+
+bool ThreadAffinity::apply() const
+{
+    if(p_cpus.empty())
+        return false;
+#if defined(__linux__) && defined(CPU_SETSIZE)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for(size_t i=0; i<p_cpus.size(); i++) {
+        if(p_cpus[i]<CPU_SETSIZE)
+            CPU_SET(p_cpus[i], &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set)==0;
+#else
+    return false;
+#endif
+}
+
 
 Runnable& Thread::Config::x_getrunner()
 {
     if(!this->p_runner)
         throw std::logic_error("Thread::Config missing run()");
+    if(!this->p_affinity.empty()) {
+        detail::AffinityRunner *wrapper = new detail::AffinityRunner(this->p_affinity, this->p_runner);
+        epics::swap(wrapper->owned, this->p_owned_runner);
+        this->p_owned_runner.reset(wrapper);
+        this->p_runner = wrapper;
+    }
     return *this->p_runner;
 }
 
@@ -79,6 +209,15 @@ Thread::Config& Thread::Config::stack(epicsThreadStackSizeClass s)
 Thread::Config& Thread::Config::autostart(bool a)
 { this->p_autostart = a; return *this; }
 
+Thread::Config& Thread::Config::affinity(const ThreadAffinity& a)
+{ this->p_affinity = a; return *this; }
+
+Thread::Config& Thread::Config::cpu(unsigned c)
+{ this->p_affinity.cpu(c); return *this; }
+
+Thread::Config& Thread::Config::numaNode(unsigned node)
+{ this->p_affinity.numaNode(node); return *this; }
+
 Thread::Config& Thread::Config::run(Runnable* r)
 { this->p_runner = r; return *this; }
 
@@ -0,0 +1,291 @@
+/* threadPool.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+
+#include <epicsThread.h>
+
+#define epicsExportSharedSymbols
+#include <pv/pvdVersion.h>
+#include <pv/threadPool.h>
+
+namespace epics { namespace pvData {
+
+struct ThreadPool::Worker {
+    ThreadPool * const owner;
+    const size_t index;
+
+    Mutex qlock;
+    std::deque<task_t> tasks; // guarded by qlock
+    Event wakeup;
+    epics::auto_ptr<Thread> thread;
+
+    Worker(ThreadPool *owner, size_t index, const Config& conf)
+        :owner(owner)
+        ,index(index)
+    {
+        thread.reset(new Thread(Thread::Config(this, &Worker::run)
+                                .prio(conf.p_prio)
+                                .autostart(false)
+                                <<conf.p_name<<'-'<<index));
+    }
+
+    void run() { owner->run(this); }
+};
+
+ThreadPool::Config::Config()
+    :p_workers(1u)
+    ,p_maxQueue(0u)
+    ,p_prio(epicsThreadPriorityLow)
+    ,p_name("ThreadPool")
+{
+#if EPICS_VERSION_INT>=VERSION_INT(3,15,0,2)
+    int n = epicsThreadGetCPUs();
+    if(n>1)
+        p_workers = size_t(n);
+#endif
+}
+
+ThreadPool::ThreadPool(const Config& conf)
+    :nqueued(0u)
+    ,nrunning(0u)
+    ,nextWorker(0u)
+    ,nblocked(0u)
+    ,accepting(true)
+    ,running(true)
+    ,maxQueue(conf.p_maxQueue)
+{
+    if(conf.p_workers==0u)
+        throw std::invalid_argument("ThreadPool requires at least one worker");
+
+    pool.reserve(conf.p_workers);
+    for(size_t i=0; i<conf.p_workers; i++)
+        pool.push_back(new Worker(this, i, conf));
+
+    // start after 'pool' is complete, as workers steal from each other
+    for(size_t i=0; i<pool.size(); i++)
+        pool[i]->thread->start();
+}
+
+ThreadPool::~ThreadPool()
+{
+    shutdown(true);
+    for(size_t i=0; i<pool.size(); i++)
+        delete pool[i];
+}
+
+ThreadPool::Worker* ThreadPool::current() const
+{
+    for(size_t i=0; i<pool.size(); i++) {
+        if(pool[i]->thread->isCurrentThread())
+            return pool[i];
+    }
+    return 0;
+}
+
+bool ThreadPool::enqueue(const task_t& task, bool wait)
+{
+    if(!task)
+        throw std::invalid_argument("NULL task");
+
+    Worker *self = current();
+    Worker *wake = 0;
+    bool space = false;
+    {
+        Lock G(lock);
+        while(true) {
+            if(!accepting) {
+                G.unlock();
+                spaceAvailable.signal(); // wake any other waiting submitter
+                return false;
+            }
+            if(!maxQueue || nqueued<maxQueue || self)
+                break;
+            if(!wait)
+                return false;
+            nblocked++;
+            G.unlock();
+            spaceAvailable.wait();
+            G.lock();
+            nblocked--;
+        }
+
+        nqueued++;
+        // spaceAvailable is a binary Event, so several dequeues may have
+        // woken only this submitter.  Pass the wakeup on if space remains.
+        space = nblocked && maxQueue && nqueued<maxQueue;
+
+        Worker *target = self ? self : pool[nextWorker++ % pool.size()];
+        {
+            Lock Q(target->qlock);
+            target->tasks.push_back(task);
+        }
+
+        if(!idle.empty()) {
+            wake = idle.back();
+            idle.pop_back();
+        }
+    }
+    if(wake)
+        wake->wakeup.signal();
+    if(space)
+        spaceAvailable.signal();
+    return true;
+}
+
+bool ThreadPool::submit(const task_t& task)
+{
+    return enqueue(task, true);
+}
+
+bool ThreadPool::trySubmit(const task_t& task)
+{
+    return enqueue(task, false);
+}
+
+#if __cplusplus>=201103L
+namespace {
+struct FunctionTask : public Runnable {
+    std::function<void()> fn;
+    explicit FunctionTask(std::function<void()>&& fn) :fn(std::move(fn)) {}
+    virtual ~FunctionTask() {}
+    virtual void run() { fn(); }
+};
+}
+
+bool ThreadPool::submit(std::function<void()>&& fn)
+{
+    task_t task(new FunctionTask(std::move(fn)));
+    return enqueue(task, true);
+}
+#endif
+
+bool ThreadPool::take(Worker* self, task_t& task)
+{
+    {
+        // own queue, most recent first
+        Lock Q(self->qlock);
+        if(!self->tasks.empty()) {
+            task.swap(self->tasks.back());
+            self->tasks.pop_back();
+            return true;
+        }
+    }
+    // steal oldest from others
+    for(size_t i=1; i<pool.size(); i++) {
+        Worker *victim = pool[(self->index+i)%pool.size()];
+        Lock Q(victim->qlock);
+        if(!victim->tasks.empty()) {
+            task.swap(victim->tasks.front());
+            victim->tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(Worker* self)
+{
+    while(true) {
+        task_t task;
+        if(take(self, task)) {
+            bool space;
+            {
+                Lock G(lock);
+                nqueued--;
+                nrunning++;
+                space = nblocked!=0u;
+            }
+            if(space)
+                spaceAvailable.signal();
+
+            try {
+                task->run();
+            } catch(std::exception& e) {
+                std::cerr<<"Unhandled exception in ThreadPool task : "<<e.what()<<"\n";
+            }
+            task.reset();
+
+            bool done;
+            {
+                Lock G(lock);
+                nrunning--;
+                done = nqueued==0u && nrunning==0u;
+            }
+            if(done)
+                drained.signal();
+            continue;
+        }
+
+        Lock G(lock);
+        if(nqueued)
+            continue; // task in transit between queue and counter
+        if(!running)
+            break;
+        idle.push_back(self);
+        G.unlock();
+        self->wakeup.wait();
+    }
+}
+
+void ThreadPool::drain()
+{
+    Lock G(lock);
+    while(nqueued || nrunning) {
+        G.unlock();
+        drained.wait();
+        G.lock();
+    }
+    G.unlock();
+    drained.signal(); // wake any other waiting drain()
+}
+
+void ThreadPool::shutdown(bool drainFirst)
+{
+    {
+        Lock G(lock);
+        if(!running)
+            return;
+        accepting = false;
+    }
+    spaceAvailable.signal();
+
+    if(!drainFirst) {
+        size_t discard = 0u;
+        for(size_t i=0; i<pool.size(); i++) {
+            Lock Q(pool[i]->qlock);
+            discard += pool[i]->tasks.size();
+            pool[i]->tasks.clear();
+        }
+        Lock G(lock);
+        nqueued -= discard;
+    }
+    drain();
+
+    {
+        Lock G(lock);
+        running = false;
+        idle.clear();
+    }
+    for(size_t i=0; i<pool.size(); i++)
+        pool[i]->wakeup.signal();
+    for(size_t i=0; i<pool.size(); i++)
+        pool[i]->thread->exitWait();
+}
+
+size_t ThreadPool::workers() const
+{
+    return pool.size();
+}
+
+size_t ThreadPool::queued() const
+{
+    Lock G(lock);
+    return nqueued;
+}
+
+}} // namespace epics::pvData
@@ -10,6 +10,8 @@
 #include <stdexcept>
 #include <string>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
 
 #include <epicsThread.h>
 #include <epicsGuard.h>
@@ -23,54 +25,213 @@ namespace epics { namespace pvData {
 
 TimerCallback::TimerCallback()
 : period(0.0),
-  onList(false)
+  slack(0.0),
+  catchUp(Timer::burst),
+  onList(false),
+  heapIndex(0u),
+  order(0u),
+  busy(false),
+  rerun(false)
 {
 }
 
 Timer::Timer(string threadName,ThreadPriority priority)
-    :waitForWork(false)
+    :nextOrder(0u)
+    ,waitForWork(false)
     ,waiting(false)
     ,alive(true)
+    ,poolSize(0u)
+    ,workReady(false)
+    ,workersRun(true)
     ,thread(threadName,priority,this)
 {}
 
+Timer::Timer(string threadName,ThreadPriority priority,size_t nworkers)
+    :nextOrder(0u)
+    ,waitForWork(false)
+    ,waiting(false)
+    ,alive(true)
+    ,poolSize(nworkers)
+    ,workReady(false)
+    ,workersRun(true)
+    ,thread(threadName,priority,this)
+{
+    startWorkers(threadName, priority);
+}
+
+Timer::Timer(string threadName,ThreadPriority priority,size_t nworkers,
+             const ThreadAffinity& affinity)
+    :nextOrder(0u)
+    ,waitForWork(false)
+    ,waiting(false)
+    ,alive(true)
+    ,poolSize(nworkers)
+    ,workReady(false)
+    ,workersRun(true)
+    ,affinity(affinity)
+    ,thread(threadName,priority,this)
+{
+    startWorkers(threadName, priority);
+}
+
+void Timer::startWorkers(const string& threadName, ThreadPriority priority)
+{
+    workers.reserve(poolSize);
+    for(size_t i=0; i<poolSize; i++) {
+        workers.push_back(new Thread(Thread::Config(this, &Timer::runWorker)
+                                     .prio(priority)
+                                     .affinity(affinity)
+                                     <<threadName<<'-'<<i));
+    }
+}
+
 struct TimerCallback::IncreasingTime {
-    bool operator()(const TimerCallbackPtr& lhs, const TimerCallbackPtr& rhs) {
+    bool operator()(const TimerCallbackPtr& lhs, const TimerCallbackPtr& rhs) const {
         assert(lhs && rhs);
-        return lhs->timeToRun < rhs->timeToRun;
+        if(lhs->timeToRun != rhs->timeToRun)
+            return lhs->timeToRun < rhs->timeToRun;
+        return lhs->order < rhs->order;
     }
 };
 
+// call with mutex held
+void Timer::siftUp(size_t index)
+{
+    TimerCallback::IncreasingTime before;
+    TimerCallbackPtr elem;
+    elem.swap(queue[index]);
+
+    while(index>0u) {
+        size_t parent = (index-1u)/2u;
+        if(!before(elem, queue[parent]))
+            break;
+        queue[index].swap(queue[parent]);
+        queue[index]->heapIndex = index;
+        index = parent;
+    }
+
+    queue[index].swap(elem);
+    queue[index]->heapIndex = index;
+}
+
+// call with mutex held
+void Timer::siftDown(size_t index)
+{
+    TimerCallback::IncreasingTime before;
+    TimerCallbackPtr elem;
+    elem.swap(queue[index]);
+    const size_t N = queue.size();
+
+    while(true) {
+        size_t child = 2u*index+1u;
+        if(child>=N)
+            break;
+        if(child+1u<N && before(queue[child+1u], queue[child]))
+            child++;
+        if(!before(queue[child], elem))
+            break;
+        queue[index].swap(queue[child]);
+        queue[index]->heapIndex = index;
+        index = child;
+    }
+
+    queue[index].swap(elem);
+    queue[index]->heapIndex = index;
+}
+
 // call with mutex held
 void Timer::addElement(TimerCallbackPtr const & timerCallback)
 {
     assert(!timerCallback->onList);
 
-    queue_t temp;
-    temp.push_back(timerCallback);
-
     timerCallback->onList = true;
+    timerCallback->order = nextOrder++;
 
-    // merge sorted lists.
-    // for us effectively insertion sort.
-    queue.merge(temp, TimerCallback::IncreasingTime());
+    queue.push_back(timerCallback);
+    siftUp(queue.size()-1u);
 }
 
+namespace {
+// Round up to a multiple of the largest power of 2 <= slack.
+// Callbacks with similar times and slack share an expiry time.
+epicsTime roundUp(const epicsTime& nominal, double slack)
+{
+    if(slack<=0.0)
+        return nominal;
+
+    int exp;
+    std::frexp(slack, &exp);
+    double grid = std::ldexp(1.0, exp-1);
+
+    epicsTimeStamp ts(nominal);
+    double rem = std::fmod(std::fmod(double(ts.secPastEpoch), grid) + ts.nsec*1e-9, grid);
+    if(rem<=0.0)
+        return nominal;
+    return nominal + (grid-rem);
+}
+}
+
+// call with mutex held
+// re-queue a periodic callback after it has run
+void Timer::reschedule(TimerCallbackPtr const & timerCallback)
+{
+    TimerCallback& cb = *timerCallback;
+    if(cb.period <= 0.0 || cb.onList)
+        return;
+
+    switch(cb.catchUp) {
+    case fixedDelay:
+        cb.nominal = epicsTime::getCurrent() + cb.period;
+        break;
+    case skipMissed: {
+        cb.nominal += cb.period;
+        epicsTime now(epicsTime::getCurrent());
+        double behind = now - cb.nominal;
+        if(behind > 0.0)
+            cb.nominal += std::ceil(behind/cb.period)*cb.period;
+    }
+        break;
+    default:
+        cb.nominal += cb.period;
+    }
+
+    cb.timeToRun = roundUp(cb.nominal, cb.slack);
+    addElement(timerCallback);
+}
+
+// call with mutex held
+TimerCallbackPtr Timer::removeElement(size_t index)
+{
+    assert(index<queue.size());
+
+    TimerCallbackPtr ret;
+    ret.swap(queue[index]);
+    ret->onList = false;
+
+    if(index+1u==queue.size()) {
+        queue.pop_back();
+    } else {
+        // move last into the hole, then restore heap order
+        queue[index].swap(queue.back());
+        queue.pop_back();
+        queue[index]->heapIndex = index;
+        if(index>0u && TimerCallback::IncreasingTime()(queue[index], queue[(index-1u)/2u]))
+            siftUp(index);
+        else
+            siftDown(index);
+    }
+    return ret;
+}
 
 bool Timer::cancel(TimerCallbackPtr const &timerCallback)
 {
     Lock xx(mutex);
     if(!timerCallback->onList) return false;
-    for(queue_t::iterator it(queue.begin()), end(queue.end()); it != end; ++it)
-    {
-        TimerCallbackPtr& cur = *it;
-        if(cur.get() == timerCallback.get()) {
-            cur->onList = false;
-            queue.erase(it); // invalidates cur and it
-            return true;
-        }
-    }
-    throw std::logic_error("Timer::cancel() onList==true, but not found");
+    size_t index = timerCallback->heapIndex;
+    if(index>=queue.size() || queue[index].get()!=timerCallback.get())
+        throw std::logic_error("Timer::cancel() onList==true, but not found");
+    removeElement(index);
+    return true;
 }
 
 bool Timer::isScheduled(TimerCallbackPtr const &timerCallback) const
@@ -82,9 +243,12 @@ bool Timer::isScheduled(TimerCallbackPtr const &timerCallback) const
 
 void Timer::run()
 {
+    if(!affinity.empty())
+        affinity.apply();
     epicsGuard<epicsMutex> G(mutex);
 
     epicsTime now(epicsTime::getCurrent());
+    bool ran = false; // 'now' is stale
 
     while(alive) {
         double waitfor;
@@ -100,10 +264,19 @@ void Timer::run()
         } else if((waitfor = queue.front()->timeToRun - now) <= 0) {
             // execute first expired job
 
-            TimerCallbackPtr work;
-            work.swap(queue.front());
-            work->onList = false;
-            queue.pop_front();
+            TimerCallbackPtr work(removeElement(0u));
+
+            if(poolSize) {
+                // hand off to a worker, which re-schedules if periodic
+                if(work->busy) {
+                    work->rerun = true; // worker will queue again when done
+                } else {
+                    work->busy = true;
+                    ready.push_back(work);
+                    workReady.signal();
+                }
+                continue;
+            }
 
             {
                 epicsGuardRelease<epicsMutex> U(G);
@@ -111,12 +284,16 @@ void Timer::run()
                 work->callback();
             }
 
-            if(work->period > 0.0) {
-                work->timeToRun += work->period;
-                addElement(work);
-            }
+            reschedule(work);
 
             // don't update 'now' until all expired jobs run
+            ran = true;
+
+        } else if(ran) {
+            // callbacks took some time.  check again before waiting
+            now = epicsTime::getCurrent();
+            ran = false;
+            continue;
 
         } else {
             waiting = true;
@@ -130,6 +307,44 @@ void Timer::run()
     }
 }
 
+void Timer::runWorker()
+{
+    Lock G(mutex);
+
+    while(workersRun) {
+        if(ready.empty()) {
+            G.unlock();
+            workReady.wait();
+            G.lock();
+            continue;
+        }
+
+        TimerCallbackPtr work;
+        work.swap(ready.front());
+        ready.pop_front();
+        if(!ready.empty())
+            workReady.signal(); // wake another worker
+
+        G.unlock();
+        work->callback();
+        G.lock();
+
+        if(work->rerun) {
+            work->rerun = false;
+            ready.push_back(work);
+            workReady.signal();
+        } else {
+            work->busy = false;
+        }
+
+        reschedule(work);
+        if(work->onList && waiting && queue.front()==work)
+            waitForWork.signal();
+    }
+
+    workReady.signal(); // wake another worker to exit
+}
+
 Timer::~Timer() {
     close();
 }
@@ -144,13 +359,31 @@ void Timer::close() {
     waitForWork.signal();
     thread.exitWait();
 
+    {
+        Lock xx(mutex);
+        workersRun = false;
+    }
+    workReady.signal();
+    for(size_t i=0; i<workers.size(); i++)
+        delete workers[i]; // joins
+    workers.clear();
+
+    std::deque<TimerCallbackPtr> notrun;
     queue_t temp;
-    temp.swap(queue);
+    {
+        Lock xx(mutex);
+        notrun.swap(ready);
+        temp.swap(queue);
+    }
+    std::sort(temp.begin(), temp.end(), TimerCallback::IncreasingTime());
 
-    for(;!temp.empty(); temp.pop_front()) {
-        TimerCallbackPtr& head = temp.front();
-        head->onList = false;
-        head->timerStopped();
+    for(size_t i=0; i<notrun.size(); i++) {
+        notrun[i]->busy = notrun[i]->rerun = false;
+        notrun[i]->timerStopped();
+    }
+    for(size_t i=0; i<temp.size(); i++) {
+        temp[i]->onList = false;
+        temp[i]->timerStopped();
     }
 }
 
@@ -158,13 +391,31 @@ void Timer::scheduleAfterDelay(
     TimerCallbackPtr const &timerCallback,
     double delay)
 {
-    schedulePeriodic(timerCallback,delay,0.0);
+    schedulePeriodic(timerCallback,delay,0.0,0.0);
+}
+
+void Timer::scheduleAfterDelay(
+    TimerCallbackPtr const &timerCallback,
+    double delay,
+    double slack)
+{
+    schedulePeriodic(timerCallback,delay,0.0,slack);
 }
 
 void Timer::schedulePeriodic(
     TimerCallbackPtr const &timerCallback,
     double delay,
     double period)
+{
+    schedulePeriodic(timerCallback,delay,period,0.0);
+}
+
+void Timer::schedulePeriodic(
+    TimerCallbackPtr const &timerCallback,
+    double delay,
+    double period,
+    double slack,
+    CatchUp catchUp)
 {
     epicsTime now(epicsTime::getCurrent());
 
@@ -181,8 +432,11 @@ void Timer::schedulePeriodic(
             return;
         }
 
-        timerCallback->timeToRun = now + delay;
+        timerCallback->nominal = now + delay;
+        timerCallback->timeToRun = roundUp(timerCallback->nominal, slack);
         timerCallback->period = period;
+        timerCallback->slack = slack;
+        timerCallback->catchUp = catchUp;
 
         addElement(timerCallback);
         wakeup = waiting && queue.front()==timerCallback;
@@ -196,7 +450,10 @@ void Timer::dump(std::ostream& o) const
     if(!alive) return;
     epicsTime now(epicsTime::getCurrent());
 
-    for(queue_t::const_iterator it(queue.begin()), end(queue.end()); it!=end; ++it) {
+    queue_t sorted(queue);
+    std::sort(sorted.begin(), sorted.end(), TimerCallback::IncreasingTime());
+
+    for(queue_t::const_iterator it(sorted.begin()), end(sorted.end()); it!=end; ++it) {
         const TimerCallbackPtr& nodeToCall = *it;
         o << "timeToRun " << (nodeToCall->timeToRun - now)
           << " period " << nodeToCall->period << "\n";
@@ -12,6 +12,7 @@
 
 #define epicsExportSharedSymbols
 #include "pv/typeCast.h"
+#include "pv/latency.h"
 
 using epics::pvData::castUnsafe;
 using epics::pvData::ScalarType;
@@ -71,6 +72,8 @@ namespace epics { namespace pvData {
 
 void castUnsafeV(size_t count, ScalarType to, void *dest, ScalarType from, const void *src)
 {
+    PVD_LATENCY_SCOPE(latencyCastUnsafeV, 0);
+    PVD_LATENCY_BYTES(count*ScalarTypeFunc::elementSize(to));
 #define COPYMEM(N) copyMem<N>(count, dest, src)
 #define CAST(TO, FROM) castVTyped<TO, FROM>(count, dest, src)
 
@@ -0,0 +1,72 @@
+/* parallelArray.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef PARALLELARRAY_H
+#define PARALLELARRAY_H
+
+#include <pv/pvData.h>
+#include <pv/parallel.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/** @defgroup parallelarray Parallel operations on large structure and union arrays
+ *
+ * Operations which split structure and union arrays into parts,
+ * which are processed concurrently by a ParallelExecutor.
+ * Arrays shorter than parallelMinElements are processed by the calling thread.
+ *
+ * Each function takes an optional executor.  If NULL, ParallelExecutor::getDefault() is used.
+ *
+ * The arrays, and their elements, must not be modified by other threads during the call.
+ *
+ * @version Added after 8.0.0
+ * @{
+ */
+
+//! Minimum number of elements in each part
+epicsShareExtern const size_t parallelMinElements;
+
+/** Replace the value of 'dest' with copies of the elements of 'src'.
+ *
+ * Unlike PVStructureArray::copyUnchecked(), which shares the element instances,
+ * each non-NULL element of 'src' is copied to a new PVStructure.
+ * As for PVStructure::copyUnchecked(), array fields of elements share storage.
+ *
+ * @throws std::invalid_argument if element types differ.
+ */
+epicsShareFunc
+void copyElements(PVStructureArray& dest, const PVStructureArray& src, ParallelExecutor* executor = 0);
+
+//! Union array variation of copyElements(PVStructureArray&, const PVStructureArray&, ParallelExecutor*)
+epicsShareFunc
+void copyElements(PVUnionArray& dest, const PVUnionArray& src, ParallelExecutor* executor = 0);
+
+//! Equivalent to operator==(const PVField&, const PVField&)
+epicsShareFunc
+bool equalElements(const PVStructureArray& a, const PVStructureArray& b, ParallelExecutor* executor = 0);
+
+//! Equivalent to operator==(const PVField&, const PVField&)
+epicsShareFunc
+bool equalElements(const PVUnionArray& a, const PVUnionArray& b, ParallelExecutor* executor = 0);
+
+/** Number of bytes written by PVField::serialize().
+ *
+ * Assumes that the SerializableControl does not cache introspection types (see SerializableControl::cachedSerialize()),
+ * which only affects union fields.
+ */
+epicsShareFunc
+size_t serializedSize(const PVStructureArray& value, ParallelExecutor* executor = 0);
+
+//! Union array variation of serializedSize(const PVStructureArray&, ParallelExecutor*)
+epicsShareFunc
+size_t serializedSize(const PVUnionArray& value, ParallelExecutor* executor = 0);
+
+/** @} */
+
+}}
+
+#endif // PARALLELARRAY_H
@@ -11,6 +11,7 @@
 
 #include <string>
 #include <map>
+#include <vector>
 #include <stdexcept>
 #include <algorithm>
 #include <iterator>
@@ -23,6 +24,8 @@
 #include <pv/typeCast.h>
 #include <pv/anyscalar.h>
 #include <pv/sharedVector.h>
+#include <pv/chunkedVector.h>
+#include <pv/circularVector.h>
 
 #include <shareLib.h>
 #include <compilerDependencies.h>
@@ -159,6 +162,12 @@ public:
      * Destructor
      */
     virtual ~PVField();
+
+    //! Allocations counted as "bytes:PVField" . @see pvd_allocstats @version Added after 8.0.0
+    static void* operator new(size_t size)
+    { return epics::detail::counted_alloc<epics::detail::allocPVField>::alloc(size); }
+    static void operator delete(void* ptr, size_t size)
+    { epics::detail::counted_alloc<epics::detail::allocPVField>::release(ptr, size); }
     /**
      * Get the fieldName for this field.
      * @return The name or empty string if top-level field.
@@ -238,7 +247,9 @@ public:
     void copy(const PVField& from);
     void copyUnchecked(const PVField& from);
 
-    static size_t num_instances; // use atomic::get() or volatile* access
+    static size_t num_instances; //!< Lags num_instances_sharded.  @see epics::ShardedCounter::setTotal()
+    //! Number of instances.  @version Added after 8.0.0
+    static epics::ShardedCounter num_instances_sharded;
     enum {isPVField=1};
 protected:
     PVField::shared_pointer getPtrSelf()
@@ -633,6 +644,8 @@ public:
 protected:
     virtual void _getAsVoid(shared_vector<const void>&) const = 0;
     virtual void _putFromVoid(const shared_vector<const void>&) = 0;
+    //! Copy array data which view() of 'from' would copy anyway.  @returns false if not handled.
+    virtual bool _copyStorage(const PVScalarArray& from);
 public:
 
     /**
@@ -689,13 +702,26 @@ public:
     }
 
     void copyUnchecked(const PVScalarArray& from) {
-        if (this==&from)
+        if (this==&from || _copyStorage(from))
             return;
         shared_vector<const void> temp;
         from._getAsVoid(temp);
         _putFromVoid(temp);
     }
 
+    /** Assign part of the given PVScalarArray's value.
+     *
+     * Elements offset, offset+stride, ... are copied, up to 'count' elements.
+     * When stride==1 and the element types match, a new reference to part of
+     * the data is kept, without copying.  Otherwise only the selected elements are copied.
+     *
+     * Calls postPut()
+     *
+     * @throws std::invalid_argument if destination is immutable, or stride==0
+     * @version Added after 8.0.0
+     */
+    void copySlice(const PVScalarArray& from, size_t offset, size_t count, size_t stride = 1u);
+
 protected:
     explicit PVScalarArray(ScalarArrayConstPtr const & scalarArray);
 private:
@@ -868,7 +894,15 @@ public:
 
     void copy(const PVStructure& from);
 
+    /** Copy values from another structure of the same type.
+     *
+     * Only scalar values are copied.
+     * Scalar array, structure array, and union array fields take a reference
+     * to the (immutable) storage of 'from', as do the array values of union fields.
+     * So the cost does not depend on the length of any array.
+     */
     void copyUnchecked(const PVStructure& from);
+    //! Copy only those fields selected by 'maskBitSet'.  Storage is shared as for copyUnchecked(const PVStructure&)
     void copyUnchecked(const PVStructure& from, const BitSet& maskBitSet, bool inverse = false);
 
     struct Formatter {
@@ -1100,6 +1134,36 @@ namespace detail {
         void operator()(T*){vec.reset();}
     };
 
+    /* Storage, within a PVValueArray, for arrays of up to 'capacity' elements.
+     * Avoids allocating a shared_vector until one is needed.
+     */
+    template<typename T>
+    struct PVArrayInline {
+        enum {bytes = 64, capacity = bytes/sizeof(T)};
+        size_t count; //!< number of elements stored here.  zero when not in use
+        T store[capacity];
+        PVArrayInline() :count(0u) {}
+        T* data() { return store; }
+        const T* data() const { return store; }
+        //! copy to a new array
+        shared_vector<const T> copy() const
+        {
+            shared_vector<T> ret(count);
+            std::copy(store, store+count, ret.begin());
+            return freeze(ret);
+        }
+    };
+    // strings are never stored inline
+    template<>
+    struct PVArrayInline<std::string> {
+        enum {capacity = 0};
+        size_t count;
+        PVArrayInline() :count(0u) {}
+        std::string* data() { return 0; }
+        const std::string* data() const { return 0; }
+        shared_vector<const std::string> copy() const { return shared_vector<const std::string>(); }
+    };
+
     //! Common code for PV*Array
     template<typename T, class Base>
     class PVVectorStorage : public Base
@@ -1159,6 +1223,35 @@ namespace detail {
             return thaw(result);
         }
 
+    protected:
+        // Helpers for arrays of PVStructurePtr or PVUnionPtr
+
+        /* Make room for 'length' elements, moving existing elements, with at most one re-allocation.
+         * 'data' must be unique(), as from reuse().
+         * Capacity grows geometrically, so repeated appends do not re-allocate each time.
+         */
+        static void growTo(svector& data, size_t length)
+        {
+            if(length <= data.capacity()) {
+                data.resize(length);
+                return;
+            }
+            svector next;
+            next.reserve(std::max(length, 2u*data.capacity()));
+            next.resize(length);
+            for(size_t i=0, N=data.size(); i<N; i++)
+                next[i].swap(data[i]);
+            data.swap(next);
+        }
+
+        // Clear an element being removed, first appending it to 'pool' if not referenced elsewhere.
+        static void toPool(svector *pool, T& elem)
+        {
+            if(pool && elem && elem.unique())
+                pool->push_back(elem);
+            elem.reset();
+        }
+
         EPICS_NOT_COPYABLE(PVVectorStorage)
     };
 } // namespace detail
@@ -1200,16 +1293,99 @@ public:
     virtual std::ostream& dumpValue(std::ostream& o) const OVERRIDE FINAL;
     virtual std::ostream& dumpValue(std::ostream& o, size_t index) const OVERRIDE FINAL;
 
-    virtual size_t getLength() const OVERRIDE FINAL {return value.size();}
-    virtual size_t getCapacity() const OVERRIDE FINAL {return value.capacity();}
+    virtual size_t getLength() const OVERRIDE FINAL {
+        return inlineValue.count ? inlineValue.count : !chunks.empty() ? chunks.size()
+                : ring.capacity() ? ring.size() : value.size();
+    }
+    virtual size_t getCapacity() const OVERRIDE FINAL {
+        return inlineValue.count ? size_t(inline_t::capacity) : !chunks.empty() ? chunks.size()
+                : ring.capacity() ? ring.capacity() : value.capacity();
+    }
 
     virtual void setCapacity(size_t capacity) OVERRIDE FINAL;
     virtual void setLength(size_t length) OVERRIDE FINAL;
 
-    virtual const_svector view() const OVERRIDE FINAL {return value;}
+    /** Array data.
+     *
+     * Arrays of up to 64 bytes (eg. 8 doubles) written by deserialize(), setLength(),
+     * or putFrom() with conversion, are kept within this PVValueArray without allocation.
+     * view() then returns a copy, while copyUnchecked() copies them into the inline
+     * storage of the destination, also without allocation.
+     * After append(), view() returns a copy joining all segments, while copyUnchecked()
+     * shares the segments.  flatten() joins them once.
+     * For a circular array, view() returns a copy if the elements wrap around.
+     */
+    virtual const_svector view() const OVERRIDE FINAL {
+        return inlineValue.count ? inlineValue.copy() : !chunks.empty() ? chunks.flatten()
+                : ring.capacity() ? ring.flatten() : value;
+    }
     virtual void swap(const_svector &other) OVERRIDE FINAL;
     virtual void replace(const const_svector& next) OVERRIDE FINAL;
 
+    /** Append elements without copying existing array data.
+     *
+     * The array is then kept as a list of segments (see chunked_vector)
+     * until flatten(), replace(), swap(), or deserialize().
+     * serialize() writes segments in order, without flattening.
+     *
+     * @throws std::logic_error if immutable, or the resulting length is not allowed.
+     * @version Added after 8.0.0
+     */
+    void append(const const_svector& more);
+    /** Remove up to n elements from the beginning.  Does not copy segments.
+     * @version Added after 8.0.0
+     */
+    void dropFront(size_t n);
+    /** Remove up to n elements from the end.  Does not copy segments.
+     * @version Added after 8.0.0
+     */
+    void dropBack(size_t n);
+    /** Join segments left by append() into one contiguous array.
+     * @version Added after 8.0.0
+     */
+    void flatten();
+    /** Segments when append() has been used, otherwise empty.
+     * @version Added after 8.0.0
+     */
+    const chunked_vector<T>& segments() const { return chunks; }
+
+    /** Make this a circular array (see circular_vector) of the given capacity,
+     * keeping the newest elements of the current array.
+     *
+     * push() and append() then replace the oldest elements once full,
+     * without shifting the array.  serialize() writes the elements oldest first,
+     * the same as for an ordinary array.
+     * setCapacity() changes the capacity.
+     * setLength(), swap(), replace(), and deserialize() return to an ordinary array.
+     *
+     * view() and spans() of an array which has not wrapped around, and spans() of one which has,
+     * reference the circular storage without copying.  While any such reference
+     * (eg. from copyUnchecked() or a monitor update) is kept, the next push() or append()
+     * first copies the whole array, O(N).  Later pushes are again O(1).
+     * So, for a strip chart copied for clients after each update, each update costs one copy.
+     *
+     * @param capacity Maximum length, or zero to return to an ordinary array.
+     * @throws std::logic_error if immutable.
+     * @version Added after 8.0.0
+     */
+    void setCircular(size_t capacity);
+    //! @version Added after 8.0.0
+    bool isCircular() const { return ring.capacity()!=0u; }
+    /** Append one element to a circular array.
+     *
+     * O(1), except for the first push() after a view() or spans() still referenced.  @see setCircular()
+     *
+     * @throws std::logic_error if immutable, or not circular.
+     * @version Added after 8.0.0
+     */
+    void push(const T& next);
+    /** Array data, oldest first, as two parts.  Does not copy.
+     *
+     * 'second' is empty unless a circular array wraps around.
+     * @version Added after 8.0.0
+     */
+    void spans(const_svector& first, const_svector& second) const;
+
     // from Serializable
     virtual void serialize(ByteBuffer *pbuffer,SerializableControl *pflusher) const OVERRIDE FINAL;
     virtual void deserialize(ByteBuffer *pbuffer,DeserializableControl *pflusher) OVERRIDE FINAL;
@@ -1219,9 +1395,19 @@ public:
 protected:
     virtual void _getAsVoid(epics::pvData::shared_vector<const void>& out) const OVERRIDE FINAL;
     virtual void _putFromVoid(const epics::pvData::shared_vector<const void>& in) OVERRIDE FINAL;
+    virtual bool _copyStorage(const PVScalarArray& from) OVERRIDE FINAL;
 
     explicit PVValueArray(ScalarArrayConstPtr const & scalar);
+    //! Move array data stored inline, in segments, or circular, to 'value'
+    void promote();
     const_svector value;
+    typedef detail::PVArrayInline<T> inline_t;
+    //! When inlineValue.count!=0, the array data.  'value', 'chunks', and 'ring' are then empty.
+    inline_t inlineValue;
+    //! When non-empty, the array data.  'value' and 'ring' are then empty.
+    chunked_vector<T> chunks;
+    //! When capacity()!=0, the array data.  'value' is then empty.
+    circular_vector<T> ring;
     friend class PVDataCreate;
     EPICS_NOT_COPYABLE(PVValueArray)
 };
@@ -1257,8 +1443,8 @@ public:
         return std::tr1::static_pointer_cast<const Array>(structureArray);
     }
 
-    virtual size_t getLength() const OVERRIDE FINAL {return value.size();}
-    virtual size_t getCapacity() const OVERRIDE FINAL {return value.capacity();}
+    virtual size_t getLength() const OVERRIDE FINAL {return columnar ? rows : value.size();}
+    virtual size_t getCapacity() const OVERRIDE FINAL {return columnar ? rows : value.capacity();}
 
     /**
      * Set the array capacity.
@@ -1282,6 +1468,33 @@ public:
      * @return the new length of the array.
      */
     std::size_t append(std::size_t number);
+    /**
+     * Append existing elements to the end of the array, with at most one re-allocation.
+     * Elements are not copied.
+     * @param elements The elements to add.  Each must be NULL, or have the same type as the array elements.
+     * @return the new length of the array.
+     * @throws std::invalid_argument if an element has a different type.
+     * @version Added after 8.0.0
+     */
+    std::size_t append(const const_svector& elements);
+    /**
+     * Append copies of a prototype element to the end of the array.
+     * @param number The number of elements to add.
+     * @param prototype Element to copy.  Must have the same type as the array elements.
+     * @return the new length of the array.
+     * @version Added after 8.0.0
+     */
+    std::size_t append(std::size_t number, const PVStructurePtr& prototype);
+    /**
+     * Append elements to the end of the array, taking them from the end of 'pool'
+     * before allocating new elements.  Elements taken from 'pool' keep their values.
+     * @param number The number of elements to add.
+     * @param pool Spare elements, eg. filled by remove().  Must have the same type as the array elements.
+     * @return the new length of the array.
+     * @throws std::invalid_argument if an element taken from 'pool' has a different type.
+     * @version Added after 8.0.0
+     */
+    std::size_t append(std::size_t number, svector& pool);
     /**
      * Remove elements from the array.
      * @param offset The offset of the first element to remove.
@@ -1289,19 +1502,90 @@ public:
      * @return (false,true) if the elements were removed.
      */
     bool remove(std::size_t offset,std::size_t number);
+    /**
+     * Remove elements from the array, keeping removed elements for re-use.
+     * Removed elements not referenced elsewhere are appended to 'pool'.
+     * @param offset The offset of the first element to remove.
+     * @param number The number of elements to remove.
+     * @param pool Receives spare elements, eg. for append(std::size_t, svector&).
+     * @return (false,true) if the elements were removed.
+     * @version Added after 8.0.0
+     */
+    bool remove(std::size_t offset,std::size_t number, svector& pool);
+    /**
+     * Remove elements at any positions from the array, in a single pass.
+     * The order of the remaining elements is kept.
+     * @param indices Offsets of the elements to remove, in any order.
+     * @return (false,true) if the elements were removed.
+     * @version Added after 8.0.0
+     */
+    bool remove(const std::vector<std::size_t>& indices);
+    /**
+     * As remove(const std::vector<std::size_t>&), appending removed elements
+     * not referenced elsewhere to 'pool'.
+     * @version Added after 8.0.0
+     */
+    bool remove(const std::vector<std::size_t>& indices, svector& pool);
     /**
      * Compress. This removes all null elements from the array.
+     * The order of the remaining elements is kept.
      */
     void compress();
 
-    virtual const_svector view() const OVERRIDE FINAL { return value; }
+    /** Array elements.
+     *
+     * For a columnar array, new PVStructure s are built from the columns,
+     * and changes to them are not reflected in this array.
+     */
+    virtual const_svector view() const OVERRIDE FINAL { return columnar ? buildRows() : value; }
     virtual void swap(const_svector &other) OVERRIDE FINAL;
     virtual void replace(const const_svector &other) OVERRIDE FINAL {
         checkLength(other.size());
         value = other;
+        dropColumns();
         PVField::postPut();
     }
 
+    /** One array per field of the element Structure, in field order.
+     * Each created with ScalarTypeFunc::allocArray() , or as shared_vector<const T> cast to void.
+     * @version Added after 8.0.0
+     */
+    typedef std::vector<shared_vector<const void> > columns_t;
+
+    /** Switch between storage as one PVStructure per element,
+     * and storage as columns (see getColumns()).
+     *
+     * A columnar array needs far fewer allocations for large arrays.
+     * getLength(), serialize(), deserialize(), getColumns() and putColumns()
+     * work on the columns directly.  view() and getRow() build rows on demand.
+     * swap(), replace(), and so append(), remove(), compress(), setLength(),
+     * and setCapacity(), return to storage as PVStructure s.
+     *
+     * @throws std::invalid_argument if the element Structure has a field which is not a scalar,
+     *         or an element is NULL.
+     * @version Added after 8.0.0
+     */
+    void setColumnar(bool columnar);
+    //! @version Added after 8.0.0
+    bool isColumnar() const { return columnar; }
+    /** Columns when isColumnar(), otherwise empty.
+     * @version Added after 8.0.0
+     */
+    const columns_t& getColumns() const { return columns; }
+    /** Replace array contents with columns, and become columnar.
+     * calls postPut()
+     *
+     * @throws std::invalid_argument if the number, types, or lengths of columns do not match the element Structure.
+     * @version Added after 8.0.0
+     */
+    void putColumns(const columns_t& columns);
+    /** A single element.  For a columnar array, a new PVStructure built from the columns.
+     *
+     * @throws std::out_of_range if index>=getLength()
+     * @version Added after 8.0.0
+     */
+    PVStructurePtr getRow(size_t index) const;
+
     virtual void serialize(ByteBuffer *pbuffer,
         SerializableControl *pflusher) const OVERRIDE FINAL;
     virtual void deserialize(ByteBuffer *buffer,
@@ -1318,8 +1602,22 @@ public:
 protected:
      PVValueArray(StructureArrayConstPtr const & structureArray);
 private:
+    bool removeRange(std::size_t offset, std::size_t number, svector *pool);
+    bool removeIndices(const std::vector<std::size_t>& indices, svector *pool);
+    const_svector buildRows() const;
+    void dropColumns() {
+        columns_t().swap(columns);
+        rows = 0u;
+        columnar = false;
+    }
+
     StructureArrayConstPtr structureArray;
+    //! When !columnar, array elements
     const_svector value;
+    //! When columnar, array elements.  'value' is then empty.
+    columns_t columns;
+    size_t rows;
+    bool columnar;
     friend class PVDataCreate;
     EPICS_NOT_COPYABLE(PVValueArray)
 };
@@ -1381,6 +1679,33 @@ public:
      * @return the new length of the array.
      */
     std::size_t append(std::size_t number);
+    /**
+     * Append existing elements to the end of the array, with at most one re-allocation.
+     * Elements are not copied.
+     * @param elements The elements to add.  Each must be NULL, or have the same type as the array elements.
+     * @return the new length of the array.
+     * @throws std::invalid_argument if an element has a different type.
+     * @version Added after 8.0.0
+     */
+    std::size_t append(const const_svector& elements);
+    /**
+     * Append copies of a prototype element to the end of the array.
+     * @param number The number of elements to add.
+     * @param prototype Element to copy.  Must have the same type as the array elements.
+     * @return the new length of the array.
+     * @version Added after 8.0.0
+     */
+    std::size_t append(std::size_t number, const PVUnionPtr& prototype);
+    /**
+     * Append elements to the end of the array, taking them from the end of 'pool'
+     * before allocating new elements.  Elements taken from 'pool' keep their values.
+     * @param number The number of elements to add.
+     * @param pool Spare elements, eg. filled by remove().  Must have the same type as the array elements.
+     * @return the new length of the array.
+     * @throws std::invalid_argument if an element taken from 'pool' has a different type.
+     * @version Added after 8.0.0
+     */
+    std::size_t append(std::size_t number, svector& pool);
     /**
      * Remove elements from the array.
      * @param offset The offset of the first element to remove.
@@ -1388,8 +1713,33 @@ public:
      * @return (false,true) if the elements were removed.
      */
     bool remove(std::size_t offset,std::size_t number);
+    /**
+     * Remove elements from the array, keeping removed elements for re-use.
+     * Removed elements not referenced elsewhere are appended to 'pool'.
+     * @param offset The offset of the first element to remove.
+     * @param number The number of elements to remove.
+     * @param pool Receives spare elements, eg. for append(std::size_t, svector&).
+     * @return (false,true) if the elements were removed.
+     * @version Added after 8.0.0
+     */
+    bool remove(std::size_t offset,std::size_t number, svector& pool);
+    /**
+     * Remove elements at any positions from the array, in a single pass.
+     * The order of the remaining elements is kept.
+     * @param indices Offsets of the elements to remove, in any order.
+     * @return (false,true) if the elements were removed.
+     * @version Added after 8.0.0
+     */
+    bool remove(const std::vector<std::size_t>& indices);
+    /**
+     * As remove(const std::vector<std::size_t>&), appending removed elements
+     * not referenced elsewhere to 'pool'.
+     * @version Added after 8.0.0
+     */
+    bool remove(const std::vector<std::size_t>& indices, svector& pool);
     /**
      * Compress. This removes all null elements from the array.
+     * The order of the remaining elements is kept.
      */
     void compress();
 
@@ -1417,6 +1767,8 @@ public:
 protected:
     explicit PVValueArray(UnionArrayConstPtr const & unionArray);
 private:
+    bool removeRange(std::size_t offset, std::size_t number, svector *pool);
+    bool removeIndices(const std::vector<std::size_t>& indices, svector *pool);
     UnionArrayConstPtr unionArray;
     const_svector value;
     friend class PVDataCreate;
@@ -1654,6 +2006,19 @@ bool epicsShareExtern operator==(const PVField&, const PVField&);
 static inline bool operator!=(const PVField& a, const PVField& b)
 {return !(a==b);}
 
+/** Compare two values, and record where they differ.
+ *
+ * Unlike operator==(), which stops at the first difference,
+ * this continues through all sub-fields setting in 'changed' the offset
+ * (see PVField::getFieldOffset()) of each differing scalar, array, or union field of 'left'.
+ * Where the types of sub-structures differ, the offset of the sub-structure is set.
+ * Bits of fields which are equal are not cleared.
+ *
+ * @returns true if left==right
+ * @version Added after 8.0.0
+ */
+epicsShareFunc bool compareValues(const PVField& left, const PVField& right, BitSet& changed);
+
 }}
 
 /**
@@ -0,0 +1,69 @@
+/* pvDataFile.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef PVDATAFILE_H
+#define PVDATAFILE_H
+
+#include <string>
+
+#include <pv/pvData.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/** @defgroup pvfile Binary file dump/load
+ *
+ * A compact, host byte order, file format for PVStructure values.
+ *
+ * The file begins with a small fixed header, followed by the
+ * introspection type in the usual network serialization, followed by
+ * the value of each field in depth first order.
+ * Scalar values are naturally aligned.
+ * The elements of primitive arrays are 16 byte aligned relative to the
+ * start of the file, which allows them to be used in place
+ * when the file is memory mapped.
+ *
+ * Not a replacement for the network format.
+ * Intended for save/restore and snapshot files which are re-read by
+ * the same (or similar) host.
+ *
+ * @{
+ */
+
+/** Write the type and value of a PVStructure to a file.
+ *
+ * Any existing file is replaced once the new file is completely written.
+ * Arrays of a previous loadFromFile() of the same path remain valid.
+ *
+ * @param value The structure to save
+ * @param path File name
+ * @throws std::runtime_error on I/O error.  An existing file is left unchanged.
+ */
+epicsShareFunc
+void saveToFile(const PVStructure& value, const std::string& path);
+
+/** Read a PVStructure previously written by saveToFile().
+ *
+ * Where the platform allows, the file is memory mapped (copy on write)
+ * and the shared_vector of each primitive array field refers directly
+ * to the mapping, so no parse or copy pass is made over array data.
+ * The mapping is held until the last such array is released.
+ * Modification of the returned structure never alters the file.
+ *
+ * Strings, and arrays from a file with non-host byte order, are copied.
+ *
+ * @param path File name
+ * @returns A new PVStructure
+ * @throws std::runtime_error on I/O error, or if the file is not valid.
+ */
+epicsShareFunc
+PVStructure::shared_pointer loadFromFile(const std::string& path);
+
+/** @} */
+
+}}
+
+#endif // PVDATAFILE_H
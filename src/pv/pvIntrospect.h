@@ -22,6 +22,8 @@
 #include <pv/byteBuffer.h>
 #include <pv/serialize.h>
 #include <pv/pvdVersion.h>
+#include <pv/reftrack.h>
+#include <pv/allocStats.h>
 
 #include <shareLib.h>
 
@@ -337,10 +339,18 @@ class epicsShareClass Field :
     virtual public Serializable,
     public std::tr1::enable_shared_from_this<Field> {
 public:
-   static size_t num_instances;
+   static size_t num_instances; //!< Lags num_instances_sharded.  @see epics::ShardedCounter::setTotal()
+   //! Number of instances.  @version Added after 8.0.0
+   static epics::ShardedCounter num_instances_sharded;
 
    POINTER_DEFINITIONS(Field);
    virtual ~Field();
+
+   //! Allocations counted as "bytes:Field" . @see pvd_allocstats @version Added after 8.0.0
+   static void* operator new(size_t size)
+   { return epics::detail::counted_alloc<epics::detail::allocField>::alloc(size); }
+   static void operator delete(void* ptr, size_t size)
+   { epics::detail::counted_alloc<epics::detail::allocField>::release(ptr, size); }
     /**
      * Get the field type.
      * @return The type.
@@ -0,0 +1,76 @@
+/* pvDiff.h */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#ifndef PVDIFF_H
+#define PVDIFF_H
+
+#include <vector>
+#include <string>
+
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+
+#include <shareLib.h>
+
+namespace epics { namespace pvData {
+
+/** @brief Per-field deadbands for diff()
+ *
+ * A change to a numeric scalar, or numeric scalar array, field is only
+ * reported if the absolute difference of some element exceeds the deadband.
+ * Fields are identified by offset (see PVField::getFieldOffset()).
+ *
+ * @code
+ *   DiffDeadband band;
+ *   band.set(*prev, "value", 0.1);
+ *   BitSet changed;
+ *   diff(*prev, *next, changed, band);
+ * @endcode
+ *
+ * @version Added after 8.0.0
+ */
+class epicsShareClass DiffDeadband {
+    std::vector<double> band; // indexed by field offset
+public:
+    //! Set deadband of the field with this offset.
+    DiffDeadband& set(size_t offset, double deadband);
+    //! Set deadband of the named sub-field of 'top'.
+    //! @throws std::runtime_error if no such field
+    DiffDeadband& set(const PVStructure& top, const std::string& fieldName, double deadband);
+    //! Deadband of the field with this offset.  Zero if not set.
+    inline double get(size_t offset) const { return offset<band.size() ? band[offset] : 0.0; }
+    inline bool empty() const { return band.empty(); }
+};
+
+/** Find the fields of 'next' which differ from 'prev'.
+ *
+ * 'changed' is cleared, then the offset of each scalar, array, or union
+ * field whose value differs is set.
+ * The result is then compressed as by BitSetUtil::compress(), where
+ * a structure with all sub-fields changed is represented by the
+ * bit of the structure alone.
+ *
+ * Suitable as mask for PVStructure::copyUnchecked(const PVStructure&, const BitSet&, bool)
+ * or for a monitor update.
+ *
+ * @param prev previous value
+ * @param next new value.  Must have the same type as 'prev'
+ * @param changed Set on return.  Offsets are those of 'prev'.
+ * @returns true if any field changed.
+ * @throws std::invalid_argument if 'prev' and 'next' have different types.
+ * @version Added after 8.0.0
+ */
+epicsShareFunc
+bool diff(const PVStructure& prev, const PVStructure& next, BitSet& changed);
+
+//! diff() with deadbands applied to numeric fields.
+//! @version Added after 8.0.0
+epicsShareFunc
+bool diff(const PVStructure& prev, const PVStructure& next, BitSet& changed,
+          const DiffDeadband& deadband);
+
+}}
+
+#endif /* PVDIFF_H */
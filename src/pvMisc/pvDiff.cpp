@@ -0,0 +1,138 @@
+/* pvDiff.cpp */
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+#include <cmath>
+#include <stdexcept>
+
+#define epicsExportSharedSymbols
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+#include <pv/pvDiff.h>
+
+namespace {
+using namespace epics::pvData;
+
+// is |a-b| beyond the deadband.  Two NaN are the same.
+inline bool outside(double a, double b, double deadband)
+{
+    if(a!=a && b!=b)
+        return false;
+    return !(std::fabs(a-b)<=deadband);
+}
+
+struct Differ {
+    BitSet& changed;
+    const DiffDeadband *band;
+
+    Differ(BitSet& changed, const DiffDeadband *band) :changed(changed), band(band) {}
+
+    bool outsideBand(const PVField& prev, const PVField& next, double deadband)
+    {
+        Type type = prev.getField()->getType();
+        if(type==scalar) {
+            const PVScalar& P = static_cast<const PVScalar&>(prev);
+            const PVScalar& N = static_cast<const PVScalar&>(next);
+            if(ScalarTypeFunc::isNumeric(P.getScalar()->getScalarType()))
+                return outside(P.getAs<double>(), N.getAs<double>(), deadband);
+
+        } else if(type==scalarArray) {
+            const PVScalarArray& P = static_cast<const PVScalarArray&>(prev);
+            const PVScalarArray& N = static_cast<const PVScalarArray&>(next);
+            if(ScalarTypeFunc::isNumeric(P.getScalarArray()->getElementType())) {
+                shared_vector<const double> pv, nv;
+                P.getAs(pv);
+                N.getAs(nv);
+                if(pv.size()!=nv.size())
+                    return true;
+                for(size_t i=0, n=pv.size(); i<n; i++) {
+                    if(outside(pv[i], nv[i], deadband))
+                        return true;
+                }
+                return false;
+            }
+        }
+        return prev!=next;
+    }
+
+    // returns true if changed
+    bool leaf(const PVField& prev, const PVField& next)
+    {
+        size_t offset = prev.getFieldOffset();
+        double deadband = band ? band->get(offset) : 0.0;
+        bool differ = deadband>0.0 ? outsideBand(prev, next, deadband) : prev!=next;
+        if(differ)
+            changed.set(offset);
+        return differ;
+    }
+
+    // returns true if all sub-fields changed, and so compressed to the structure bit
+    bool structure(const PVStructure& prev, const PVStructure& next)
+    {
+        const PVFieldPtrArray& pfields = prev.getPVFields();
+        const PVFieldPtrArray& nfields = next.getPVFields();
+        if(pfields.empty())
+            return false;
+
+        bool all = true;
+        for(size_t i=0, nfld=pfields.size(); i<nfld; i++) {
+            const PVField& P = *pfields[i];
+            const PVField& N = *nfields[i];
+            if(P.getField()->getType()==epics::pvData::structure)
+                all &= structure(static_cast<const PVStructure&>(P), static_cast<const PVStructure&>(N));
+            else
+                all &= leaf(P, N);
+        }
+
+        if(all) {
+            size_t offset = prev.getFieldOffset();
+            for(size_t i=offset+1, end=prev.getNextFieldOffset(); i<end; i++)
+                changed.clear(i);
+            changed.set(offset);
+        }
+        return all;
+    }
+};
+
+bool doDiff(const PVStructure& prev, const PVStructure& next, BitSet& changed,
+            const DiffDeadband *band)
+{
+    if(*prev.getStructure()!=*next.getStructure())
+        throw std::invalid_argument("diff() requires structures of the same type");
+
+    changed.clear();
+    Differ D(changed, band);
+    D.structure(prev, next);
+    return !changed.isEmpty();
+}
+
+} // namespace
+
+namespace epics { namespace pvData {
+
+DiffDeadband& DiffDeadband::set(size_t offset, double deadband)
+{
+    if(offset>=band.size())
+        band.resize(offset+1, 0.0);
+    band[offset] = deadband;
+    return *this;
+}
+
+DiffDeadband& DiffDeadband::set(const PVStructure& top, const std::string& fieldName, double deadband)
+{
+    return set(top.getSubFieldT(fieldName)->getFieldOffset(), deadband);
+}
+
+bool diff(const PVStructure& prev, const PVStructure& next, BitSet& changed)
+{
+    return doDiff(prev, next, changed, 0);
+}
+
+bool diff(const PVStructure& prev, const PVStructure& next, BitSet& changed,
+          const DiffDeadband& deadband)
+{
+    return doDiff(prev, next, changed, deadband.empty() ? 0 : &deadband);
+}
+
+}} // namespace epics::pvData
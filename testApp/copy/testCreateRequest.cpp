@@ -697,11 +697,140 @@ void testMaskErr()
     testThrows(std::runtime_error, PVRequestMapper mapper(*base, *createRequest("field(invalid)"), PVRequestMapper::Slice));
 }
 
+void testSlice()
+{
+    testDiag("=== %s", CURRENT_FUNCTION);
+
+    PVStructurePtr pvRequest(createRequest("field(value[2:3],alarm)"));
+    testOk1(!!pvRequest);
+    if(pvRequest)
+        testFieldEqual<PVString>(pvRequest, "field.value._options.slice", "2:3");
+
+    StructureConstPtr type(getFieldCreate()->createFieldBuilder()
+                           ->addArray("value", pvDouble)
+                           ->add("A", pvInt)
+                           ->createStructure());
+
+    PVStructurePtr base(getPVDataCreate()->createPVStructure(type));
+    {
+        PVDoubleArray::svector V(10);
+        for(size_t i=0; i<V.size(); i++)
+            V[i] = double(i);
+        base->getSubFieldT<PVDoubleArray>("value")->replace(freeze(V));
+    }
+    PVDoubleArray::const_svector full(base->getSubFieldT<PVDoubleArray>("value")->view());
+
+    {
+        testDiag("contiguous slice references the base array");
+        PVRequestMapper mapper(*base, *createRequest("field(value[2:3])"), PVRequestMapper::Slice);
+        testEqual(mapper.warnings(), "");
+
+        PVStructurePtr req(getPVDataCreate()->createPVStructure(mapper.requested()));
+        BitSet output;
+        mapper.copyBaseToRequested(*base, BitSet().set(0), *req, output);
+
+        PVDoubleArray::const_svector part(req->getSubFieldT<PVDoubleArray>("value")->view());
+        testEqual(part.size(), 3u);
+        testOk1(part.data()==full.data()+2);
+        testOk1(output.get(req->getSubFieldT("value")->getFieldOffset()));
+
+        // not copied back
+        req->getSubFieldT<PVDoubleArray>("value")->replace(PVDoubleArray::const_svector());
+        BitSet changed;
+        mapper.copyBaseFromRequested(*base, changed, *req, output);
+        testEqual(base->getSubFieldT<PVDoubleArray>("value")->view().size(), 10u);
+        testOk1(!changed.get(base->getSubFieldT("value")->getFieldOffset()));
+    }
+    {
+        testDiag("strided slice, clipped to the array length");
+        PVRequestMapper mapper(*base, *createRequest("field(value[1:100:3],A)"), PVRequestMapper::Mask);
+        testEqual(mapper.warnings(), "");
+
+        PVStructurePtr req(getPVDataCreate()->createPVStructure(mapper.requested()));
+        BitSet output;
+        mapper.copyBaseToRequested(*base, BitSet().set(0), *req, output);
+
+        PVDoubleArray::const_svector part(req->getSubFieldT<PVDoubleArray>("value")->view());
+        testEqual(part.size(), 3u);
+        if(part.size()==3u)
+            testOk(part[0]==1.0 && part[1]==4.0 && part[2]==7.0, "%g %g %g", part[0], part[1], part[2]);
+        else
+            testFail("wrong size");
+    }
+    {
+        testDiag("slice of a non-array field");
+        PVRequestMapper mapper(*base, *createRequest("field(A[0:1])"), PVRequestMapper::Slice);
+        testEqual(mapper.warnings(), "slice only applies to variable size scalar array, or union 'A' ");
+    }
+    {
+        testDiag("slice of an array held by a union, and a huge stride");
+        StructureConstPtr utype(getFieldCreate()->createFieldBuilder()
+                                ->add("value", getFieldCreate()->createVariantUnion())
+                                ->createStructure());
+        PVStructurePtr ubase(getPVDataCreate()->createPVStructure(utype));
+        PVDoubleArrayPtr arr(getPVDataCreate()->createPVScalarArray<PVDoubleArray>());
+        arr->replace(full);
+        ubase->getSubFieldT<PVUnion>("value")->set(arr);
+
+        PVRequestMapper mapper(*ubase, *createRequest("field(value[3:2])"), PVRequestMapper::Slice);
+        testEqual(mapper.warnings(), "");
+
+        PVStructurePtr req(mapper.buildRequested());
+        BitSet output;
+        mapper.copyBaseToRequested(*ubase, BitSet().set(0), *req, output);
+        PVDoubleArrayPtr part(req->getSubFieldT<PVUnion>("value")->get<PVDoubleArray>());
+        testOk1(part && part->view().size()==2u && part->view().data()==full.data()+3);
+
+        PVRequestMapper huge(*ubase, *createRequest("field(value[1:5:18446744073709551615])"), PVRequestMapper::Slice);
+        huge.copyBaseToRequested(*ubase, BitSet().set(0), *req, output);
+        part = req->getSubFieldT<PVUnion>("value")->get<PVDoubleArray>();
+        testOk1(part && part->view().size()==1u && part->view()[0]==1.0);
+
+        // a union holding a scalar is copied
+        ubase->getSubFieldT<PVUnion>("value")->set(getPVDataCreate()->createPVScalar<PVInt>());
+        mapper.copyBaseToRequested(*ubase, BitSet().set(0), *req, output);
+        testOk1(!!req->getSubFieldT<PVUnion>("value")->get<PVInt>());
+    }
+}
+
+void testCached()
+{
+    testDiag("=== %s", CURRENT_FUNCTION);
+
+    PVStructurePtr base(getPVDataCreate()->createPVStructure(maskingType)),
+                   other(getPVDataCreate()->createPVStructure(maskingType));
+
+    PVRequestMapper::const_shared_pointer A(PVRequestMapper::cached(*base, *createRequest("field(A,B)"), PVRequestMapper::Slice)),
+                                          B(PVRequestMapper::cached(*other, *createRequest("field(A,B)"), PVRequestMapper::Slice)),
+                                          C(PVRequestMapper::cached(*base, *createRequest("field(A,B)"), PVRequestMapper::Mask)),
+                                          D(PVRequestMapper::cached(*base, *createRequest("field(A)"), PVRequestMapper::Slice));
+
+    testOk1(A==B); // same Structure and request
+    testOk1(A!=C);
+    testOk1(A!=D);
+    testEqual(A->requestedMask(), BitSet().set(0)
+              .set(base->getSubFieldT("A")->getFieldOffset())
+              .set(base->getSubFieldT("B")->getFieldOffset()));
+
+    // shared mapping used with different instances
+    base->getSubFieldT<PVInt>("A")->put(1);
+    other->getSubFieldT<PVInt>("A")->put(2);
+    PVStructurePtr reqA(A->buildRequested()), reqB(B->buildRequested());
+    BitSet outA, outB;
+    A->copyBaseToRequested(*base, BitSet().set(0), *reqA, outA);
+    B->copyBaseToRequested(*other, BitSet().set(0), *reqB, outB);
+    testFieldEqual<PVInt>(reqA, "A", 1);
+    testFieldEqual<PVInt>(reqB, "A", 2);
+    testEqual(outA, outB);
+
+    testThrows(std::runtime_error, PVRequestMapper::cached(*base, *createRequest("field(invalid)")));
+}
+
 } // namespace
 
 MAIN(testCreateRequest)
 {
-    testPlan(315);
+    testPlan(339);
     testCreateRequestInternal();
     testBadRequest();
     testMapper(PVRequestMapper::Slice);
@@ -728,6 +857,8 @@ MAIN(testCreateRequest)
     TEST_METHOD(MapperMask, testMaskSub2R2B);
     testMaskWarn();
     testMaskErr();
+    testSlice();
+    testCached();
     return testDone();
 }
 
@@ -0,0 +1,100 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+// Measure Mutex and Event compared with SpinMutex and SpinEvent, under contention.
+
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+#include <epicsTime.h>
+
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+// short critical sections from several threads
+template<typename M>
+struct Contend {
+    M lock;
+    size_t count;
+    const size_t iterations;
+    explicit Contend(size_t iterations) :count(0u), iterations(iterations) {}
+    void run()
+    {
+        for(size_t i=0; i<iterations; i++) {
+            pvd::Lock G(lock);
+            count++;
+        }
+    }
+};
+
+template<typename M>
+void measureContend(const char *name, size_t nthreads, size_t iterations)
+{
+    Contend<M> contend(iterations);
+    std::vector<pvd::Thread*> threads;
+
+    epicsTime start(epicsTime::getCurrent());
+    for(size_t i=0; i<nthreads; i++)
+        threads.push_back(new pvd::Thread(pvd::Thread::Config(&contend, &Contend<M>::run)
+                                          <<"contend"<<i));
+    for(size_t i=0; i<nthreads; i++)
+        delete threads[i]; // joins
+    epicsTime end(epicsTime::getCurrent());
+
+    size_t total = nthreads*iterations;
+    testDiag("%-10s %u threads  %.3f us/lock  %.0f locks/s", name, unsigned(nthreads),
+             (end-start)/total*1e6, total/(end-start));
+}
+
+// two threads handing off through a pair of events
+template<typename E>
+struct PingPong {
+    E ping, pong;
+    const size_t iterations;
+    explicit PingPong(size_t iterations) :iterations(iterations) {}
+    void run()
+    {
+        for(size_t i=0; i<iterations; i++) {
+            ping.wait();
+            pong.signal();
+        }
+    }
+};
+
+template<typename E>
+void measurePingPong(const char *name, size_t iterations)
+{
+    PingPong<E> pp(iterations);
+    pvd::Thread other(pvd::Thread::Config(&pp, &PingPong<E>::run).name("pong"));
+
+    epicsTime start(epicsTime::getCurrent());
+    for(size_t i=0; i<iterations; i++) {
+        pp.ping.signal();
+        pp.pong.wait();
+    }
+    epicsTime end(epicsTime::getCurrent());
+
+    testDiag("%-10s %.3f us/round trip", name, (end-start)/iterations*1e6);
+}
+
+} // namespace
+
+MAIN(performLock)
+{
+    testPlan(0);
+    const size_t iterations = 1000000;
+    for(size_t nthreads=1; nthreads<=8; nthreads*=2) {
+        measureContend<pvd::Mutex>("Mutex", nthreads, iterations/nthreads);
+        measureContend<pvd::SpinMutex>("SpinMutex", nthreads, iterations/nthreads);
+    }
+    measurePingPong<pvd::Event>("Event", iterations/10);
+    measurePingPong<pvd::SpinEvent>("SpinEvent", iterations/10);
+    return testDone();
+}
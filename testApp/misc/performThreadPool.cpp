@@ -0,0 +1,159 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+// Measure ThreadPool task throughput, compared with workers sharing a single mutex protected queue.
+
+#include <deque>
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+#include <epicsTime.h>
+
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/threadPool.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct NoOp : public pvd::Runnable {
+    virtual ~NoOp() {}
+    virtual void run() {}
+};
+
+// baseline.  All workers take from one queue.
+struct SharedQueue {
+    pvd::Mutex lock;
+    pvd::Event wakeup, drained;
+    std::deque<pvd::ThreadPool::task_t> tasks;
+    size_t pending;
+    bool run;
+    std::vector<pvd::Thread*> workers;
+
+    explicit SharedQueue(size_t nworkers) :pending(0u), run(true)
+    {
+        for(size_t i=0; i<nworkers; i++)
+            workers.push_back(new pvd::Thread(pvd::Thread::Config(this, &SharedQueue::work)
+                                              <<"baseline"<<i));
+    }
+    ~SharedQueue()
+    {
+        {
+            pvd::Lock G(lock);
+            run = false;
+        }
+        wakeup.signal();
+        for(size_t i=0; i<workers.size(); i++)
+            delete workers[i];
+    }
+    void submit(const pvd::ThreadPool::task_t& task)
+    {
+        {
+            pvd::Lock G(lock);
+            tasks.push_back(task);
+            pending++;
+        }
+        wakeup.signal();
+    }
+    void drain()
+    {
+        pvd::Lock G(lock);
+        while(pending) {
+            G.unlock();
+            drained.wait();
+            G.lock();
+        }
+    }
+    void work()
+    {
+        pvd::Lock G(lock);
+        while(run) {
+            if(tasks.empty()) {
+                G.unlock();
+                wakeup.wait();
+                G.lock();
+                continue;
+            }
+            pvd::ThreadPool::task_t task;
+            task.swap(tasks.front());
+            tasks.pop_front();
+            if(!tasks.empty())
+                wakeup.signal();
+            G.unlock();
+            task->run();
+            task.reset();
+            G.lock();
+            if(--pending==0)
+                drained.signal();
+        }
+        wakeup.signal();
+    }
+};
+
+template<typename Q>
+void measure(const char *name, Q& queue, size_t count)
+{
+    pvd::ThreadPool::task_t task(new NoOp);
+
+    epicsTime start(epicsTime::getCurrent());
+    for(size_t i=0; i<count; i++)
+        queue.submit(task);
+    queue.drain();
+    epicsTime end(epicsTime::getCurrent());
+
+    testDiag("%-12s %8u tasks  %.3f us/task  %.0f tasks/s", name, unsigned(count),
+             (end-start)/count*1e6, count/(end-start));
+}
+
+// tasks submitted by tasks, which ThreadPool keeps on the submitting worker
+struct Fanout : public pvd::Runnable {
+    pvd::ThreadPool& pool;
+    size_t count;
+    Fanout(pvd::ThreadPool& pool, size_t count) :pool(pool), count(count) {}
+    virtual ~Fanout() {}
+    virtual void run()
+    {
+        pvd::ThreadPool::task_t task(new NoOp);
+        for(size_t i=0; i<count; i++)
+            pool.submit(task);
+    }
+};
+
+void measureFanout(size_t nworkers, size_t count)
+{
+    pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(nworkers));
+
+    epicsTime start(epicsTime::getCurrent());
+    for(size_t i=0; i<nworkers; i++)
+        pool.submit(pvd::ThreadPool::task_t(new Fanout(pool, count/nworkers)));
+    pool.drain();
+    epicsTime end(epicsTime::getCurrent());
+
+    testDiag("%-12s %8u tasks  %.3f us/task  %.0f tasks/s", "fanout", unsigned(count),
+             (end-start)/count*1e6, count/(end-start));
+}
+
+} // namespace
+
+MAIN(performThreadPool)
+{
+    testPlan(0);
+    const size_t count = 1000000;
+    for(size_t nworkers=1; nworkers<=8; nworkers*=2) {
+        testDiag("%u workers", unsigned(nworkers));
+        {
+            SharedQueue queue(nworkers);
+            measure("mutex+queue", queue, count);
+        }
+        {
+            pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(nworkers));
+            measure("ThreadPool", pool, count);
+        }
+        measureFanout(nworkers, count);
+    }
+    return testDone();
+}
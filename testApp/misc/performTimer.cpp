@@ -0,0 +1,70 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+// Measure the cost of Timer schedule and cancel as the number of queued callbacks grows.
+
+#include <vector>
+#include <cstdlib>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+#include <epicsTime.h>
+
+#include <pv/timer.h>
+
+namespace {
+
+namespace pvd = epics::pvData;
+
+struct NoOp : public pvd::TimerCallback {
+    virtual ~NoOp() {}
+    virtual void callback() {}
+    virtual void timerStopped() {}
+};
+
+void scaling(size_t count)
+{
+    pvd::Timer timer("performTimer", pvd::lowPriority);
+
+    std::vector<pvd::TimerCallbackPtr> cbs(count);
+    for(size_t i=0; i<count; i++)
+        cbs[i].reset(new NoOp);
+
+    // shuffle so that cancel order differs from schedule order
+    std::vector<size_t> order(count);
+    for(size_t i=0; i<count; i++)
+        order[i] = i;
+    srand(42);
+    for(size_t i=count; i>1; i--)
+        std::swap(order[i-1], order[rand()%i]);
+
+    epicsTime start(epicsTime::getCurrent());
+
+    // far enough in the future that none expire
+    for(size_t i=0; i<count; i++)
+        timer.schedulePeriodic(cbs[i], 1000.0+double(order[i]%1000u), 1.0);
+
+    epicsTime mid(epicsTime::getCurrent());
+
+    for(size_t i=0; i<count; i++)
+        timer.cancel(cbs[order[i]]);
+
+    epicsTime end(epicsTime::getCurrent());
+
+    testDiag("%8u callbacks  schedule %.3f us  cancel %.3f us",
+             unsigned(count),
+             (mid-start)/count*1e6,
+             (end-mid)/count*1e6);
+}
+
+} // namespace
+
+MAIN(performTimer)
+{
+    testPlan(0);
+    scaling(10000);
+    scaling(100000);
+    scaling(1000000);
+    return testDone();
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/allocStats.h>
+#include <pv/reftrack.h>
+#include <pv/sharedVector.h>
+#include <pv/byteBuffer.h>
+#include <pv/pvData.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+struct Other { int a, b; };
+
+long bytes(const char *name)
+{
+    return long(epics::readRefCounter(name));
+}
+
+void testVector()
+{
+    testDiag("testVector");
+
+    long before = bytes("bytes:shared_vector<double>");
+    {
+        pvd::shared_vector<double> V(100);
+        testEqual(bytes("bytes:shared_vector<double>")-before, long(100*sizeof(double)));
+
+        V.resize(200);
+        testEqual(bytes("bytes:shared_vector<double>")-before, long(200*sizeof(double)));
+
+        pvd::shared_vector<const double> C(pvd::freeze(V));
+        testEqual(bytes("bytes:shared_vector<double>")-before, long(200*sizeof(double)));
+
+        pvd::shared_vector<double> D(pvd::thaw(C));
+        D.make_unique();
+        testEqual(bytes("bytes:shared_vector<double>")-before, long(200*sizeof(double)));
+    }
+    testEqual(bytes("bytes:shared_vector<double>"), before);
+
+    long sbefore = bytes("bytes:shared_vector<string>"),
+         obefore = bytes("bytes:shared_vector<other>");
+    {
+        pvd::shared_vector<std::string> S(4);
+        pvd::shared_vector<Other> O;
+        O.reserve(3);
+        testEqual(bytes("bytes:shared_vector<string>")-sbefore, long(4*sizeof(std::string)));
+        testEqual(bytes("bytes:shared_vector<other>")-obefore, long(3*sizeof(Other)));
+    }
+    testEqual(bytes("bytes:shared_vector<string>"), sbefore);
+    testEqual(bytes("bytes:shared_vector<other>"), obefore);
+}
+
+void testByteBuffer()
+{
+    testDiag("testByteBuffer");
+
+    long before = bytes("bytes:ByteBuffer");
+    {
+        pvd::ByteBuffer buf(1024);
+        testEqual(bytes("bytes:ByteBuffer")-before, 1024L);
+
+        char raw[16];
+        pvd::ByteBuffer wrapped(raw, sizeof(raw));
+        testEqual(bytes("bytes:ByteBuffer")-before, 1024L);
+    }
+    testEqual(bytes("bytes:ByteBuffer"), before);
+}
+
+void testPVField()
+{
+    testDiag("testPVField");
+
+    epics::RefSnapshot before;
+    before.update();
+
+    pvd::StructureConstPtr type(pvd::getFieldCreate()->createFieldBuilder()
+                                ->setId("testAllocStats_t")
+                                ->add("value", pvd::pvDouble)
+                                ->addArray("arr", pvd::pvInt)
+                                ->createStructure());
+    pvd::PVStructurePtr value(pvd::getPVDataCreate()->createPVStructure(type));
+
+    epics::RefSnapshot after;
+    after.update();
+    epics::RefSnapshot delta(after-before);
+
+    testDiag("PVField %ld  Field %ld", delta["bytes:PVField"].delta, delta["bytes:Field"].delta);
+    testOk1(delta["bytes:PVField"].delta >= long(3*sizeof(pvd::PVField)));
+    testOk1(delta["bytes:Field"].delta >= long(sizeof(pvd::Structure)));
+
+    long pvbefore = bytes("bytes:PVField");
+    value.reset();
+    testOk1(bytes("bytes:PVField") < pvbefore);
+    testEqual(bytes("bytes:PVField"), long(before["bytes:PVField"].current));
+}
+
+} // namespace
+
+MAIN(testAllocStats)
+{
+    testPlan(17);
+    if(!epics::enableAllocStats()) {
+        testSkip(17, "Allocation accounting not available");
+    } else {
+        testOk1(epics::allocStatsEnabled());
+        testVector();
+        testByteBuffer();
+        testPVField();
+    }
+    return testDone();
+}
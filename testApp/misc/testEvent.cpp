@@ -6,7 +6,10 @@
 #include <epicsUnitTest.h>
 #include <testMain.h>
 
+#include <pv/lock.h>
 #include <pv/event.h>
+#include <pv/thread.h>
+#include <pv/pvUnitTest.h>
 
 using namespace epics::pvData;
 
@@ -41,10 +44,79 @@ static void testBasicEvent()
     testOk1(!e.tryWait());
 }
 
+static void testSpinEvent()
+{
+    testDiag("testSpinEvent");
+
+    SpinEvent e(false, 10u, 4u);
+
+    testOk1(!e.tryWait());
+    e.signal();
+    testOk1(e.tryWait());
+    testOk1(!e.tryWait());
+
+    e.signal();
+    testOk1(e.wait());
+    testOk(!e.wait(0.01), "timeout after spin");
+
+    SpinEvent full(true);
+    testOk1(full.wait());
+    testOk1(!full.tryWait());
+
+    // never spins
+    SpinEvent nospin(false, 0u);
+    nospin.signal();
+    testOk1(nospin.wait(0.01));
+}
+
+namespace {
+struct Counter {
+    SpinMutex lock;
+    size_t count;
+    Counter() :lock(1000u), count(0u) {}
+    void run()
+    {
+        for(size_t i=0; i<10000; i++) {
+            Lock G(lock);
+            count++;
+        }
+    }
+};
+}
+
+static void testSpinMutex()
+{
+    testDiag("testSpinMutex");
+
+    Counter counter;
+    {
+        Lock G(counter.lock);
+        testOk1(G.ownsLock());
+        G.unlock();
+        testOk1(!G.ownsLock());
+        G.lock();
+        testOk1(G.ownsLock());
+        // recursive
+        Lock G2(counter.lock);
+        testOk1(counter.lock.tryLock());
+        counter.lock.unlock();
+    }
+
+    {
+        Thread A(Thread::Config(&counter, &Counter::run).name("A"));
+        Thread B(Thread::Config(&counter, &Counter::run).name("B"));
+        counter.run();
+    }
+    Lock G(counter.lock);
+    testEqual(counter.count, 30000u);
+}
+
 MAIN(testEvent)
 {
-    testPlan(9);
+    testPlan(22);
     testBasicEvent();
+    testSpinEvent();
+    testSpinMutex();
     return testDone();
 }
  
@@ -0,0 +1,119 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <sstream>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/latency.h>
+#include <pv/typeCast.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+void testBuckets()
+{
+    testDiag("testBuckets");
+
+    typedef epics::LatencyHistogram H;
+
+    testEqual(H::bucketOf(0u), 0u);
+    testEqual(H::bucketOf(15u), 15u);
+    testEqual(H::bucketOf(16u), 16u);
+    testEqual(H::bucketOf(31u), 31u);
+    testEqual(H::bucketOf(32u), 32u);
+    testEqual(H::bucketOf(33u), 32u);
+    testEqual(H::bucketOf(~epicsUInt64(0u)), size_t(H::nbuckets-1));
+
+    // every value is within the bounds of its bucket
+    bool ok = true;
+    for(epicsUInt64 v=1u; v<(epicsUInt64(1u)<<62u); v = v*3u+1u) {
+        size_t idx = H::bucketOf(v);
+        ok &= H::bucketLow(idx)<=v && v<=H::bucketHigh(idx);
+        ok &= H::bucketHigh(idx)-H::bucketLow(idx) <= v/8u;
+    }
+    testOk(ok, "bucket bounds");
+}
+
+epics::LatencyHistogram hist;
+
+void testSnapshot()
+{
+    testDiag("testSnapshot");
+
+    epics::registerLatencyHistogram("test", &hist);
+
+    epics::LatencySnapshot snap1;
+    snap1.update();
+    testEqual(snap1["test"].count, 0u);
+
+    for(epicsUInt64 i=1u; i<=100u; i++)
+        hist.record(i*1000u, 10u);
+
+    epics::LatencySnapshot snap2;
+    snap2.update();
+    const epics::LatencySnapshot::Stats& S = snap2["test"];
+    testEqual(S.count, 100u);
+    testEqual(S.bytes, 1000u);
+    testEqual(S.mean(), 50500.0);
+    // within bucket precision
+    testOk(S.percentile(0.5)>=50000u && S.percentile(0.5)<=53000u, "p50 %llu", (unsigned long long)S.percentile(0.5));
+    testOk(S.percentile(1.0)>=100000u && S.percentile(1.0)<=106000u, "max %llu", (unsigned long long)S.percentile(1.0));
+
+    hist.record(5u);
+
+    epics::LatencySnapshot snap3;
+    snap3.update();
+    epics::LatencySnapshot delta(snap3-snap2);
+    testEqual(delta["test"].count, 1u);
+    testEqual(delta["test"].percentile(1.0), 5u);
+
+    std::ostringstream strm;
+    strm<<delta;
+    testOk(strm.str().find("test:\t1 calls, 0 bytes")!=std::string::npos, "print");
+
+    epics::unregisterLatencyHistogram("test", &hist);
+    epics::LatencySnapshot snap4;
+    snap4.update();
+    testEqual(snap4["test"].count, 0u);
+}
+
+void testProbes()
+{
+    testDiag("testProbes");
+
+    epics::LatencySnapshot before;
+    before.update();
+    testOk(before.size()>=7u, "built in probes registered");
+
+    pvd::int32 src[4] = {1, 2, 3, 4};
+    double dest[4];
+    pvd::castUnsafeV(4, pvd::pvDouble, dest, pvd::pvInt, src);
+
+    epics::LatencySnapshot after;
+    after.update();
+    epics::LatencySnapshot delta(after-before);
+
+    if(epics::latencyInstrumented()) {
+        testEqual(delta["castUnsafeV"].count, 1u);
+        testEqual(delta["castUnsafeV"].bytes, 4u*sizeof(double));
+    } else {
+        testSkip(2, "Built without PVD_LATENCY_STATS");
+    }
+}
+
+} // namespace
+
+MAIN(testLatency)
+{
+    testPlan(21);
+    testBuckets();
+    testSnapshot();
+    testProbes();
+    return testDone();
+}
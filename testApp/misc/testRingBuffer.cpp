@@ -0,0 +1,216 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <vector>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+#include <epicsThread.h>
+
+#include <pv/thread.h>
+#include <pv/ringBuffer.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+void testFIFO()
+{
+    testDiag("testFIFO");
+
+    pvd::SPSCRing<int> ring(3);
+    testEqual(ring.capacity(), 4u);
+    testOk1(ring.empty());
+    testEqual(ring.size(), 0u);
+
+    int val = -1;
+    testOk(!ring.tryPop(val), "pop empty");
+
+    bool ok = true;
+    for(int i=0; i<4; i++)
+        ok &= ring.tryPush(i);
+    testOk(ok, "fill");
+    testOk(!ring.tryPush(4), "push full");
+    testEqual(ring.size(), 4u);
+
+    // wrap around several times
+    ok = true;
+    for(int i=4; i<20; i++) {
+        ok &= ring.tryPop(val) && val==i-4;
+        ok &= ring.tryPush(i);
+    }
+    testOk(ok, "wrap around");
+
+    ok = true;
+    for(int i=16; i<20; i++)
+        ok &= ring.tryPop(val) && val==i;
+    testOk(ok, "drain");
+    testOk1(ring.empty());
+}
+
+void testSharedPtr()
+{
+    testDiag("testSharedPtr");
+
+    std::tr1::shared_ptr<int> value(new int(42));
+    pvd::SPSCRing<std::tr1::shared_ptr<int> > ring(2);
+
+    ring.push(value);
+    testEqual(value.use_count(), 2);
+
+    std::tr1::shared_ptr<int> out;
+    ring.pop(out);
+    testOk1(out==value);
+    // ring does not keep a reference
+    out.reset();
+    testEqual(value.use_count(), 1);
+}
+
+struct Producer {
+    pvd::MPSCRing<unsigned>& ring;
+    const unsigned id, count;
+    Producer(pvd::MPSCRing<unsigned>& ring, unsigned id, unsigned count)
+        :ring(ring), id(id), count(count) {}
+    void run()
+    {
+        // high byte is the producer id
+        for(unsigned i=0; i<count; i++)
+            ring.push((id<<24u) | i);
+    }
+};
+
+void testMPSC()
+{
+    testDiag("testMPSC");
+
+    const unsigned nproducers = 4, count = 10000;
+    pvd::MPSCRing<unsigned> ring(16);
+
+    std::vector<Producer*> producers;
+    std::vector<pvd::Thread*> threads;
+    for(unsigned i=0; i<nproducers; i++) {
+        producers.push_back(new Producer(ring, i, count));
+        threads.push_back(new pvd::Thread(pvd::Thread::Config(producers.back(), &Producer::run)
+                                          <<"producer"<<i));
+    }
+
+    std::vector<unsigned> next(nproducers, 0u);
+    bool inorder = true;
+    for(unsigned n=0; n<nproducers*count; n++) {
+        unsigned val;
+        ring.pop(val);
+        unsigned id = val>>24u, seq = val&0xffffffu;
+        if(id>=nproducers || seq!=next[id]) {
+            inorder = false;
+            continue;
+        }
+        next[id]++;
+    }
+    testOk(inorder, "per producer order");
+
+    bool complete = true;
+    for(unsigned i=0; i<nproducers; i++)
+        complete &= next[i]==count;
+    testOk(complete, "all received");
+    testOk1(ring.empty());
+
+    for(unsigned i=0; i<nproducers; i++) {
+        delete threads[i];
+        delete producers[i];
+    }
+}
+
+struct BlockedPush {
+    pvd::MPSCRing<unsigned>& ring;
+    const unsigned value;
+    pvd::Event done;
+    BlockedPush(pvd::MPSCRing<unsigned>& ring, unsigned value) :ring(ring), value(value) {}
+    void run()
+    {
+        ring.push(value);
+        done.signal();
+    }
+};
+
+void testBlockedProducers()
+{
+    testDiag("testBlockedProducers");
+
+    const unsigned nproducers = 8;
+    pvd::MPSCRing<unsigned> ring(nproducers);
+
+    bool ok = true;
+    for(unsigned i=0; i<nproducers; i++)
+        ok &= ring.tryPush(i);
+    testOk(ok, "fill");
+
+    std::vector<BlockedPush*> producers;
+    std::vector<pvd::Thread*> threads;
+    for(unsigned i=0; i<nproducers; i++) {
+        producers.push_back(new BlockedPush(ring, nproducers+i));
+        threads.push_back(new pvd::Thread(pvd::Thread::Config(producers.back(), &BlockedPush::run)
+                                          <<"push"<<i));
+    }
+    epicsThreadSleep(0.1);
+
+    // free every slot, then stop popping
+    ok = true;
+    for(unsigned i=0; i<nproducers; i++) {
+        unsigned val;
+        ok &= ring.tryPop(val) && val==i;
+    }
+    testOk(ok, "drain");
+
+    ok = true;
+    for(unsigned i=0; i<nproducers; i++)
+        ok &= producers[i]->done.wait(5.0);
+    testOk(ok, "all blocked producers done");
+    testEqual(ring.size(), size_t(nproducers));
+
+    for(unsigned i=0; i<nproducers; i++) {
+        delete threads[i];
+        delete producers[i];
+    }
+}
+
+struct DelayedPush {
+    pvd::SPSCRing<int>& ring;
+    explicit DelayedPush(pvd::SPSCRing<int>& ring) :ring(ring) {}
+    void run()
+    {
+        epicsThreadSleep(0.1);
+        ring.push(5);
+    }
+};
+
+void testTimeout()
+{
+    testDiag("testTimeout");
+
+    pvd::SPSCRing<int> ring(2);
+    int val = -1;
+
+    testOk(!ring.pop(val, 0.05), "pop timeout");
+
+    DelayedPush pusher(ring);
+    pvd::Thread thread(pvd::Thread::Config(&pusher, &DelayedPush::run).name("pusher"));
+
+    testOk(ring.pop(val, 5.0), "pop wakeup");
+    testEqual(val, 5);
+}
+
+} // namespace
+
+MAIN(testRingBuffer)
+{
+    testPlan(23);
+    testFIFO();
+    testSharedPtr();
+    testMPSC();
+    testBlockedProducers();
+    testTimeout();
+    return testDone();
+}
@@ -330,6 +330,29 @@ void testCapacity()
     testOk1(vect[1]==124);
 }
 
+void testResizeUninitialized()
+{
+    testDiag("Test resize_uninitialized()");
+
+    pvd::shared_vector<pvd::int32> vect(10, 1);
+    pvd::int32 *peek = vect.dataPtr().get();
+
+    vect.resize_uninitialized(8);
+    testOk1(vect.dataPtr().get() == peek);
+    testOk1(vect.size()==8);
+
+    pvd::shared_vector<pvd::int32> other(vect);
+
+    vect.resize_uninitialized(8);
+    testOk1(vect.dataPtr().get() != peek);
+    testOk1(vect.unique() && other.unique());
+    testOk1(other.size()==8 && other[0]==1);
+
+    vect.resize_uninitialized(20);
+    testOk1(vect.size()==20);
+    testOk1(vect.dataTotal()==20);
+}
+
 void testPush()
 {
     pvd::shared_vector<pvd::int32> vect;
@@ -431,6 +454,50 @@ void testNonPOD()
     testOk1(structs2[1].get()==temp);
 }
 
+struct Tracked {
+    static int instances, throwAfter;
+    Tracked() {
+        if(throwAfter==0)
+            throw std::runtime_error("Tracked ctor");
+        else if(throwAfter>0)
+            throwAfter--;
+        instances++;
+    }
+    Tracked(const Tracked&) { instances++; }
+    ~Tracked() { instances--; }
+};
+int Tracked::instances;
+int Tracked::throwAfter = -1;
+
+void testElementLifetime()
+{
+#ifdef PVD_SHARED_VECTOR_SINGLE_ALLOC
+    testDiag("Test element construction and destruction, with single allocation");
+#else
+    testDiag("Test element construction and destruction");
+#endif
+
+    {
+        pvd::shared_vector<Tracked> A(5);
+        testOk1(Tracked::instances==5);
+
+        A.push_back(Tracked());
+        testOk1(Tracked::instances==(int)A.capacity() && A.size()==6);
+    }
+    testOk1(Tracked::instances==0);
+
+    Tracked::throwAfter = 3;
+    testThrows(std::runtime_error, pvd::shared_vector<Tracked> B(5));
+    Tracked::throwAfter = -1;
+    testOk1(Tracked::instances==0);
+
+    pvd::shared_vector<double> V(4, 1.0);
+    std::tr1::weak_ptr<double> W(V.dataPtr());
+    testOk1(!W.expired());
+    V.clear();
+    testOk1(W.expired());
+}
+
 void testVectorConvert()
 {
     testDiag("Test shared_vector_convert");
@@ -691,11 +758,78 @@ void testCXX11Init()
 #endif
 }
 
+
+struct CountingAllocator : public pvd::AlignedAllocator {
+    size_t nalloc, nfree, bytes;
+    CountingAllocator() :pvd::AlignedAllocator(64), nalloc(0u), nfree(0u), bytes(0u) {}
+    virtual ~CountingAllocator() {}
+    virtual void* allocate(size_t n)
+    {
+        nalloc++;
+        bytes += n;
+        return pvd::AlignedAllocator::allocate(n);
+    }
+    virtual void deallocate(void* ptr, size_t n)
+    {
+        nfree++;
+        bytes -= n;
+        pvd::AlignedAllocator::deallocate(ptr, n);
+    }
+};
+
+void testAllocator()
+{
+    testDiag("Test ArrayAllocator");
+
+    std::tr1::shared_ptr<CountingAllocator> alloc(new CountingAllocator);
+
+    {
+        pvd::shared_vector<double> A(10, alloc);
+        testOk1(alloc->nalloc==1 && alloc->bytes==10*sizeof(double));
+        testOk1((size_t(A.data())&63u)==0u);
+
+        pvd::shared_vector<const double> C(pvd::freeze(A));
+        testOk1(alloc->nfree==0);
+        A = pvd::thaw(C);
+        testOk1(alloc->nfree==0 && A.size()==10);
+    }
+    testOk1(alloc->nalloc==1 && alloc->nfree==1 && alloc->bytes==0);
+
+    {
+        pvd::ArrayAllocator::Scope S(alloc);
+        testOk1(pvd::ArrayAllocator::current()==alloc);
+
+        pvd::shared_vector<std::string> A(2);
+        A[0] = "hello";
+        A.push_back("world");
+        testOk1(alloc->nalloc==3 && alloc->nfree==2);
+        testOk1(A.size()==3 && A[0]=="hello" && A[2]=="world");
+
+        {
+            pvd::ArrayAllocator::Scope S2((pvd::ArrayAllocator::shared_pointer()));
+            testOk1(!pvd::ArrayAllocator::current());
+            pvd::shared_vector<double> B(4);
+            testOk1(alloc->nalloc==3);
+        }
+        testOk1(pvd::ArrayAllocator::current()==alloc);
+    }
+    testOk1(!pvd::ArrayAllocator::current());
+    testOk1(alloc->nalloc==3 && alloc->nfree==3 && alloc->bytes==0);
+
+    pvd::shared_vector<pvd::int32> B(4, 42);
+    B.reserve(8, alloc);
+    testOk1(alloc->nalloc==4 && B.size()==4 && B[3]==42 && B.capacity()==8);
+    B.clear();
+    testOk1(alloc->nfree==4);
+
+    testThrows(std::invalid_argument, pvd::AlignedAllocator(24));
+}
+
 } // namespace
 
 MAIN(testSharedVector)
 {
-    testPlan(191);
+    testPlan(221);
     testDiag("Tests for shared_vector");
 
     testDiag("sizeof(shared_vector<pvd::int32>)=%lu",
@@ -705,6 +839,7 @@ MAIN(testSharedVector)
     testInternalAlloc();
     testExternalAlloc();
     testCapacity();
+    testResizeUninitialized();
     testShare();
     testConst();
     testSlice();
@@ -712,6 +847,7 @@ MAIN(testSharedVector)
     testVoid();
     testConstVoid();
     testNonPOD();
+    testElementLifetime();
     testVectorConvert();
     testWeak();
     testICE();
@@ -719,5 +855,6 @@ MAIN(testSharedVector)
     testAutoSwap();
     testCXX11Move();
     testCXX11Init();
+    testAllocator();
     return testDone();
 }
@@ -23,6 +23,7 @@
 
 #include <pv/event.h>
 #include <pv/thread.h>
+#include <pv/pvUnitTest.h>
 
 using namespace epics::pvData;
 using std::string;
@@ -152,11 +153,48 @@ static void testBinders()
 #endif
 }
 
+static void testAffinity()
+{
+    testDiag("Testing ThreadAffinity");
+
+    ThreadAffinity aff(ThreadAffinity::parse("4, 0-2,1"));
+    std::vector<unsigned> expect;
+    expect.push_back(0u);
+    expect.push_back(1u);
+    expect.push_back(2u);
+    expect.push_back(4u);
+    testOk(aff.cpus()==expect, "parse sorted, without duplicates");
+    testOk1(ThreadAffinity::parse("").empty());
+    testOk1(ThreadAffinity::parse("3\n").cpus()==std::vector<unsigned>(1, 3u));
+
+    testThrows(std::invalid_argument, ThreadAffinity::parse("1,,2"));
+    testThrows(std::invalid_argument, ThreadAffinity::parse("2-1"));
+    testThrows(std::invalid_argument, ThreadAffinity::parse("-1"));
+    testThrows(std::invalid_argument, ThreadAffinity::parse("1-x"));
+    testThrows(std::invalid_argument, ThreadAffinity::parse("0-99999999"));
+
+    testOk1(!ThreadAffinity().apply());
+    testOk1(ThreadAffinity().numaNode(99999u).empty());
+    testEqual(ThreadAffinity::interfaceNumaNode("nosuchinterface"), -1);
+
+    // CPU 0 always exists.  Thread runs whether or not pinning is supported.
+    fninfo info;
+    info.cnt = 0;
+    {
+        Thread pinned(Thread::Config(&threadFN, (void*)&info)
+                      .cpu(0u)
+                      .name("pinned"));
+        info.evnt.wait();
+    }
+    testOk(info.cnt==1, "pinned thread ran");
+}
+
 MAIN(testThread)
 {
-    testPlan(6);
+    testPlan(18);
     testDiag("Tests thread");
     testThreadRun();
     testBinders();
+    testAffinity();
     return testDone();
 }
@@ -0,0 +1,228 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <stdexcept>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/lock.h>
+#include <pv/event.h>
+#include <pv/threadPool.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+struct Count {
+    pvd::Mutex lock;
+    size_t count;
+    Count() :count(0u) {}
+    void inc() { pvd::Lock G(lock); count++; }
+    size_t get() { pvd::Lock G(lock); return count; }
+};
+
+struct CountTask : public pvd::Runnable {
+    Count& count;
+    explicit CountTask(Count& count) :count(count) {}
+    virtual ~CountTask() {}
+    virtual void run() { count.inc(); }
+};
+
+// blocks until released
+struct BlockTask : public pvd::Runnable {
+    pvd::Event started, release;
+    virtual ~BlockTask() {}
+    virtual void run()
+    {
+        started.signal();
+        release.wait();
+    }
+    void delayedRelease()
+    {
+        epicsThreadSleep(0.1);
+        release.signal();
+    }
+};
+
+// submits two children until depth is reached
+struct TreeTask : public pvd::Runnable {
+    pvd::ThreadPool& pool;
+    Count& count;
+    unsigned depth;
+    TreeTask(pvd::ThreadPool& pool, Count& count, unsigned depth) :pool(pool), count(count), depth(depth) {}
+    virtual ~TreeTask() {}
+    virtual void run()
+    {
+        count.inc();
+        if(depth>0) {
+            pool.submit(pvd::ThreadPool::task_t(new TreeTask(pool, count, depth-1)));
+            pool.submit(pvd::ThreadPool::task_t(new TreeTask(pool, count, depth-1)));
+        }
+    }
+};
+
+// submit() from another thread
+struct Submitter {
+    pvd::ThreadPool& pool;
+    Count& count;
+    bool ok;
+    pvd::Event done;
+    Submitter(pvd::ThreadPool& pool, Count& count) :pool(pool), count(count), ok(false) {}
+    void run()
+    {
+        ok = pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+        done.signal();
+    }
+};
+
+struct ThrowTask : public pvd::Runnable {
+    virtual ~ThrowTask() {}
+    virtual void run() { throw std::runtime_error("expected error"); }
+};
+
+void testBasic()
+{
+    testDiag("testBasic");
+
+    pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(3).name("testpool"));
+    testEqual(pool.workers(), 3u);
+
+    Count count;
+    bool ok = true;
+    for(size_t i=0; i<1000; i++)
+        ok &= pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+    testOk(ok, "submit");
+    pool.drain();
+    testEqual(count.get(), 1000u);
+    testEqual(pool.queued(), 0u);
+}
+
+void testStealing()
+{
+    testDiag("testStealing");
+
+    pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(4));
+
+    Count count;
+    pool.submit(pvd::ThreadPool::task_t(new TreeTask(pool, count, 10)));
+    pool.drain();
+    testEqual(count.get(), (1u<<11)-1u);
+}
+
+void testBounded()
+{
+    testDiag("testBounded");
+
+    pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(1).maxQueue(2));
+
+    std::tr1::shared_ptr<BlockTask> block(new BlockTask);
+    pool.submit(block);
+    block->started.wait();
+
+    Count count;
+    testOk1(pool.trySubmit(pvd::ThreadPool::task_t(new CountTask(count))));
+    testOk1(pool.trySubmit(pvd::ThreadPool::task_t(new CountTask(count))));
+    testOk(!pool.trySubmit(pvd::ThreadPool::task_t(new CountTask(count))), "queue full");
+    testEqual(pool.queued(), 2u);
+
+    block->release.signal();
+    // waits for space
+    testOk1(pool.submit(pvd::ThreadPool::task_t(new CountTask(count))));
+    pool.drain();
+    testEqual(count.get(), 3u);
+}
+
+void testBoundedMany()
+{
+    testDiag("testBoundedMany");
+
+    pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(1).maxQueue(2));
+
+    std::tr1::shared_ptr<BlockTask> block(new BlockTask);
+    pool.submit(block);
+    block->started.wait();
+
+    Count count;
+    pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+    pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+
+    // two submitters blocked on a full queue
+    Submitter A(pool, count), B(pool, count);
+    pvd::Thread tA(pvd::Thread::Config(&A, &Submitter::run).name("submitA"));
+    pvd::Thread tB(pvd::Thread::Config(&B, &Submitter::run).name("submitB"));
+    epicsThreadSleep(0.1);
+    testEqual(pool.queued(), 2u);
+
+    block->release.signal();
+
+    testOk(A.done.wait(5.0) && A.ok, "submitter A done");
+    testOk(B.done.wait(5.0) && B.ok, "submitter B done");
+    pool.drain();
+    testEqual(count.get(), 4u);
+}
+
+void testShutdown()
+{
+    testDiag("testShutdown");
+
+    Count count;
+    {
+        pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(1));
+
+        std::tr1::shared_ptr<BlockTask> block(new BlockTask);
+        pool.submit(block);
+        block->started.wait();
+
+        for(size_t i=0; i<10; i++)
+            pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+
+        // release once shutdown() has discarded the queue
+        pvd::Thread releaser(pvd::Thread::Config(block.get(), &BlockTask::delayedRelease)
+                             .name("releaser"));
+        pool.shutdown(false);
+        testEqual(count.get(), 0u);
+        testOk(!pool.submit(pvd::ThreadPool::task_t(new CountTask(count))), "rejected after shutdown");
+    }
+
+    count.count = 0u;
+    {
+        pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(2));
+        for(size_t i=0; i<100; i++)
+            pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+        // destructor drains
+    }
+    testEqual(count.get(), 100u);
+}
+
+void testError()
+{
+    testDiag("testError");
+
+    pvd::ThreadPool pool(pvd::ThreadPool::Config().workers(1));
+
+    Count count;
+    pool.submit(pvd::ThreadPool::task_t(new ThrowTask));
+    pool.submit(pvd::ThreadPool::task_t(new CountTask(count)));
+    pool.drain();
+    testEqual(count.get(), 1u);
+
+    testThrows(std::invalid_argument, pvd::ThreadPool(pvd::ThreadPool::Config().workers(0)));
+}
+
+} // namespace
+
+MAIN(testThreadPool)
+{
+    testPlan(20);
+    testBasic();
+    testStealing();
+    testBounded();
+    testBoundedMany();
+    testShutdown();
+    testError();
+    return testDone();
+}
@@ -16,6 +16,8 @@
 #include <cstdio>
 #include <iostream>
 #include <exception>
+#include <vector>
+#include <algorithm>
 
 #include <epicsUnitTest.h>
 #include <testMain.h>
@@ -219,9 +221,226 @@ static void testCancel(unsigned oneOrd, unsigned twoOrd, unsigned threeOrd,
     }
 }
 
+struct Counter : public TimerCallback
+{
+    POINTER_DEFINITIONS(Counter);
+    unsigned count;
+    Counter() :count(0) {}
+    virtual ~Counter() {}
+    virtual void callback() { count++; }
+    virtual void timerStopped() {}
+};
+
+// cancel many callbacks, in an order different from the time order
+static void testCancelMany()
+{
+    testDiag("testCancelMany");
+
+    Timer timer("timer" ,middlePriority);
+
+    const size_t N = 1000;
+    std::vector<Counter::shared_pointer> cbs(N);
+    for(size_t i=0; i<N; i++) {
+        cbs[i].reset(new Counter);
+        timer.scheduleAfterDelay(cbs[i], 100.0+double((i*7919u)%N));
+    }
+
+    bool ok = true;
+    for(size_t i=0; i<N; i+=2)
+        ok &= timer.cancel(cbs[(i*31u)%N]);
+    testOk(ok, "cancel() finds all queued");
+
+    size_t nqueued = 0;
+    for(size_t i=0; i<N; i++)
+        nqueued += timer.isScheduled(cbs[i]);
+    testOk(nqueued==N/2, "%u queued == %u", unsigned(nqueued), unsigned(N/2));
+
+    size_t ncancel = 0;
+    for(size_t i=0; i<N; i++)
+        ncancel += timer.cancel(cbs[i]);
+    testOk(ncancel==N/2, "%u cancelled == %u", unsigned(ncancel), unsigned(N/2));
+}
+
+struct Slow : public TimerCallback
+{
+    POINTER_DEFINITIONS(Slow);
+    Mutex lock;
+    unsigned count, active, maxActive, stopped;
+    Slow() :count(0), active(0), maxActive(0), stopped(0) {}
+    virtual ~Slow() {}
+    virtual void callback()
+    {
+        {
+            Lock G(lock);
+            count++;
+            if(++active>maxActive)
+                maxActive = active;
+        }
+        epicsThreadSleep(0.01);
+        {
+            Lock G(lock);
+            active--;
+        }
+    }
+    virtual void timerStopped()
+    {
+        Lock G(lock);
+        stopped++;
+    }
+};
+
+// callbacks run on a worker pool
+static void testPool()
+{
+    testDiag("testPool");
+
+    Timer timer("timer" ,middlePriority, 2);
+
+    Marker::shared_pointer marker(new Marker);
+    MyCallbackPtr callbackOne(new MyCallback("one"));
+    Slow::shared_pointer slow(new Slow);
+
+    timer.scheduleAfterDelay(marker, 0.0);
+    marker->wait.wait();
+    // one worker is blocked
+
+    callbackOne->clear();
+    timer.scheduleAfterDelay(callbackOne, 0.01);
+    callbackOne->wait.wait();
+    testOk(callbackOne->counter==1, "callback runs while another is blocked");
+
+    // period shorter than callback run time
+    timer.schedulePeriodic(slow, 0.0, 0.001);
+    epicsThreadSleep(0.2);
+    timer.cancel(slow);
+    {
+        Lock G(slow->lock);
+        testOk(slow->count>1, "periodic count %u > 1", slow->count);
+        testOk(slow->maxActive==1, "callback never concurrent with itself (%u)", slow->maxActive);
+    }
+
+    // both workers blocked, so the next callback is stopped, not run, by close()
+    Marker::shared_pointer marker2(new Marker);
+    timer.scheduleAfterDelay(marker2, 0.0);
+    marker2->wait.wait();
+
+    Slow::shared_pointer pending(new Slow);
+    timer.scheduleAfterDelay(pending, 0.0);
+    epicsThreadSleep(0.05);
+
+    marker->hold.signal();
+    marker2->hold.signal();
+    timer.close();
+
+    Lock G(pending->lock);
+    testOk(pending->count+pending->stopped==1, "pending callback either run (%u) or stopped (%u)",
+           pending->count, pending->stopped);
+}
+
+struct Recorder : public TimerCallback
+{
+    POINTER_DEFINITIONS(Recorder);
+    Mutex lock;
+    std::vector<epicsTime> starts, ends;
+    double sleepFirst;
+    Event done;
+    size_t expect;
+    Recorder(size_t expect, double sleepFirst=0.0) :sleepFirst(sleepFirst), expect(expect) {}
+    virtual ~Recorder() {}
+    virtual void callback()
+    {
+        epicsTime start(epicsTime::getCurrent());
+        bool first;
+        {
+            Lock G(lock);
+            first = starts.empty();
+        }
+        if(first && sleepFirst>0.0)
+            epicsThreadSleep(sleepFirst);
+        Lock G(lock);
+        starts.push_back(start);
+        ends.push_back(epicsTime::getCurrent());
+        if(starts.size()==expect)
+            done.signal();
+    }
+    virtual void timerStopped() {}
+};
+
+// callbacks with slack expire together
+static void testSlack()
+{
+    testDiag("testSlack");
+
+    Timer timer("timer" ,middlePriority);
+
+    const size_t N = 50;
+    std::vector<Recorder::shared_pointer> cbs(N);
+    for(size_t i=0; i<N; i++) {
+        cbs[i].reset(new Recorder(1));
+        // spread over 0.1 sec.
+        timer.scheduleAfterDelay(cbs[i], 0.1+0.002*i, 0.25);
+    }
+
+    for(size_t i=0; i<N; i++)
+        cbs[i]->done.wait(5.0);
+
+    std::vector<epicsTime> times(N);
+    for(size_t i=0; i<N; i++) {
+        Lock G(cbs[i]->lock);
+        times[i] = cbs[i]->starts.empty() ? epicsTime() : cbs[i]->starts[0];
+    }
+    std::sort(times.begin(), times.end());
+
+    // slack rounds to a 0.125 sec. grid.  So at most two groups
+    size_t groups = 1;
+    for(size_t i=1; i<N; i++) {
+        if(times[i]-times[i-1] > 0.05)
+            groups++;
+    }
+    testOk(groups<=2, "%u groups <= 2", unsigned(groups));
+}
+
+static void testCatchUp(Timer::CatchUp policy, const char *name)
+{
+    testDiag("testCatchUp %s", name);
+
+    Timer timer("timer" ,middlePriority);
+
+    // first callback runs for 10 periods
+    Recorder::shared_pointer cb(new Recorder(12, 0.1));
+    timer.schedulePeriodic(cb, 0.0, 0.01, 0.0, policy);
+    cb->done.wait(5.0);
+    timer.cancel(cb);
+    timer.close();
+
+    Lock G(cb->lock);
+    if(!testOk(cb->starts.size()>=12, "ran %u times", unsigned(cb->starts.size())))
+        return;
+    // delay between end of the slow run and start of the next
+    double gap = cb->starts[1] - cb->ends[0];
+    // number of runs immediately after the slow run
+    size_t immediate = 0;
+    for(size_t i=1; i<cb->starts.size(); i++) {
+        if(cb->starts[i] - cb->ends[0] < 0.005)
+            immediate++;
+    }
+
+    switch(policy) {
+    case Timer::burst:
+        testOk(immediate>=5, "burst %u immediate >= 5", unsigned(immediate));
+        break;
+    case Timer::skipMissed:
+        testOk(immediate<=2, "skip %u immediate <= 2", unsigned(immediate));
+        break;
+    case Timer::fixedDelay:
+        testOk(gap > 0.009, "fixed delay %f > 0.009", gap);
+        break;
+    }
+}
+
 MAIN(testTimer)
 {
-    testPlan(315);
+    testPlan(329);
     try {
         testDiag("Tests timer");
 
@@ -234,6 +453,13 @@ MAIN(testTimer)
         testBasic(0, 2, 1);
         testCancel(0, 2, 1, 0, 1);
 
+        testCancelMany();
+        testPool();
+        testSlack();
+        testCatchUp(Timer::burst, "burst");
+        testCatchUp(Timer::skipMissed, "skipMissed");
+        testCatchUp(Timer::fixedDelay, "fixedDelay");
+
     }catch(std::exception& e) {
         testFail("Unhandled exception: %s", e.what());
     }
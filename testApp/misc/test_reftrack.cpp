@@ -10,6 +10,9 @@
 
 #include <pv/epicsException.h>
 #include <pv/reftrack.h>
+#include <pv/thread.h>
+#include <pv/pvData.h>
+#include <pv/pvUnitTest.h>
 
 namespace {
 
@@ -86,14 +89,111 @@ void testSnap()
     testOk1(delta13["cnt3"]==epics::RefSnapshot::Count(23, 23));
 }
 
+epics::ShardedCounter shcnt;
+
+struct Churn {
+    void run()
+    {
+        for(size_t i=0; i<1000; i++)
+            REFTRACE_INCREMENT(shcnt);
+        for(size_t i=0; i<500; i++)
+            REFTRACE_DECREMENT(shcnt);
+    }
+};
+
+void testSharded()
+{
+    testDiag("testSharded()");
+
+    testEqual(shcnt.get(), 0u);
+
+    epics::registerRefCounter("shcnt", &shcnt);
+    testEqual(epics::readRefCounter("shcnt"), 0u);
+
+    Churn churn;
+    {
+        epics::pvData::Thread A(epics::pvData::Thread::Config(&churn, &Churn::run).name("A"));
+        epics::pvData::Thread B(epics::pvData::Thread::Config(&churn, &Churn::run).name("B"));
+        churn.run();
+    }
+
+    // decrement from a different thread than increment
+    for(size_t i=0; i<1500; i++)
+        REFTRACE_DECREMENT(shcnt);
+#ifdef REFTRACK_USE_ATOMIC
+    testEqual(epics::readRefCounter("shcnt"), 0u);
+#else
+    testSkip(1, "No atomic counters");
+#endif
+    for(size_t i=0; i<3; i++)
+        REFTRACE_INCREMENT(shcnt);
+
+    epics::RefSnapshot snap;
+    snap.update();
+#ifdef REFTRACK_USE_ATOMIC
+    testOk1(snap["shcnt"]==epics::RefSnapshot::Count(3, 0));
+#else
+    testSkip(1, "No atomic counters");
+#endif
+
+    epics::unregisterRefCounter("shcnt", &shcnt);
+    testEqual(epics::readRefCounter("shcnt"), 0u);
+
+    {
+        size_t before = epics::pvData::PVField::num_instances_sharded;
+        epics::pvData::PVScalarPtr value(epics::pvData::getPVDataCreate()->createPVScalar(epics::pvData::pvInt));
+#ifdef REFTRACK_USE_ATOMIC
+        testEqual(epics::readRefCounter("PVField"), before+1u);
+#else
+        testSkip(1, "No atomic counters");
+#endif
+    }
+}
+
+epics::ShardedCounter shtotal;
+size_t total;
+
+void testShardedTotal()
+{
+    testDiag("testShardedTotal()");
+
+    testOk((size_t(&shtotal)%64u)==0u, "shards cache line aligned");
+
+    shtotal.setTotal(&total);
+    for(size_t i=0; i<1000; i++)
+        REFTRACE_INCREMENT(shtotal);
+#ifdef REFTRACK_USE_ATOMIC
+    testEqual(shtotal.get(), 1000u);
+    // this thread's shard is added to the total in batches
+    testOk(total<=1000u && total+epics::ShardedCounter::flushAt>1000u, "total %u", unsigned(total));
+#else
+    testSkip(2, "No atomic counters");
+#endif
+    for(size_t i=0; i<1000; i++)
+        REFTRACE_DECREMENT(shtotal);
+#ifdef REFTRACK_USE_ATOMIC
+    testEqual(shtotal.get(), 0u);
+    // within flushAt of zero, either side
+    testOk(total+epics::ShardedCounter::flushAt < size_t(2*epics::ShardedCounter::flushAt), "total %d", int(total));
+#else
+    testSkip(2, "No atomic counters");
+#endif
+
+    // size_t counters remain for existing users
+    const size_t *legacy = &epics::pvData::PVField::num_instances;
+    testOk1(legacy!=0);
+}
+
 } // namespace
 
 MAIN(test_reftrack)
 {
-    testPlan(18);
+    testPlan(30);
     try {
         testReg();
         testSnap();
+        testSharded();
+        testShardedTotal();
     }catch(std::exception& e){
         PRINT_EXCEPTION(e);
         testAbort("Unexpected exception: %s", e.what());
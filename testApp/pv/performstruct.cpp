@@ -10,6 +10,7 @@
 #include <pv/current_function.h>
 #include <pv/pvData.h>
 #include <pv/standardField.h>
+#include <pv/parallelArray.h>
 
 namespace {
 
@@ -105,11 +106,69 @@ void buildHit()
     record.report("us", 1e-6);
 }
 
+// copy of a structure with a large array (shared) and some scalars
+void copyLarge()
+{
+    testDiag("%s", CURRENT_FUNCTION);
+    TimeIt record;
+
+    pvd::StandardFieldPtr standard(pvd::getStandardField());
+    pvd::StructureConstPtr type(standard->scalarArray(pvd::pvDouble, "alarm,timeStamp,display"));
+
+    pvd::PVStructurePtr src(pvd::getPVDataCreate()->createPVStructure(type)),
+                        dest(pvd::getPVDataCreate()->createPVStructure(type));
+    {
+        pvd::PVDoubleArray::svector arr(1024*1024/sizeof(double), 1.0);
+        src->getSubFieldT<pvd::PVDoubleArray>("value")->replace(pvd::freeze(arr));
+    }
+
+    for(size_t i=0; i<1000; i++) {
+        record.start();
+        dest->copyUnchecked(*src);
+        record.end();
+    }
+
+    record.report("us", 1e-6);
+}
+
+// copy of a table with 100k rows, with 1 thread and with the default executor
+void copyTable(pvd::ParallelExecutor *exec)
+{
+    testDiag("%s concurrency=%u", CURRENT_FUNCTION, exec ? unsigned(exec->concurrency()) : 0u);
+    TimeIt record;
+
+    pvd::StandardFieldPtr standard(pvd::getStandardField());
+    pvd::StructureConstPtr type(standard->scalar(pvd::pvDouble, "alarm,timeStamp"));
+
+    pvd::PVStructureArrayPtr src(pvd::getPVDataCreate()->createPVStructureArray(type)),
+                             dest(pvd::getPVDataCreate()->createPVStructureArray(type));
+    {
+        pvd::PVStructureArray::svector rows(100000);
+        for(size_t i=0; i<rows.size(); i++)
+            rows[i] = pvd::getPVDataCreate()->createPVStructure(type);
+        src->replace(pvd::freeze(rows));
+    }
+
+    for(size_t i=0; i<10; i++) {
+        record.start();
+        pvd::copyElements(*dest, *src, exec);
+        record.end();
+    }
+
+    record.report("ms", 1e-3);
+}
+
 } // namespace
 
 MAIN(performStruct) {
     testPlan(0);
     buildMiss();
     buildHit();
+    copyLarge();
+    {
+        pvd::ParallelExecutor::shared_pointer serial(pvd::ParallelExecutor::create(0));
+        copyTable(serial.get());
+        copyTable(0);
+    }
     return testDone();
 }
@@ -0,0 +1,225 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <epicsMath.h>
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/pvData.h>
+#include <pv/bitSet.h>
+#include <pv/pvDiff.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+pvd::StructureConstPtr makeType()
+{
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->add("a", pvd::pvInt)
+            ->addArray("b", pvd::pvInt)
+            ->addNestedStructure("c")
+                ->add("d", pvd::pvDouble)
+                ->add("e", pvd::pvString)
+            ->endNested()
+            ->addArray("f", pvd::pvDouble)
+            ->add("g", pvd::getFieldCreate()->createVariantUnion())
+            ->createStructure();
+}
+
+void fill(const pvd::PVStructurePtr& val)
+{
+    val->getSubFieldT<pvd::PVInt>("a")->put(1);
+    pvd::PVIntArray::svector b(100);
+    for(size_t i=0; i<b.size(); i++)
+        b[i] = int(i);
+    val->getSubFieldT<pvd::PVIntArray>("b")->replace(pvd::freeze(b));
+    val->getSubFieldT<pvd::PVDouble>("c.d")->put(2.0);
+    val->getSubFieldT<pvd::PVString>("c.e")->put("hello");
+    pvd::PVDoubleArray::svector f(3, 1.5);
+    val->getSubFieldT<pvd::PVDoubleArray>("f")->replace(pvd::freeze(f));
+}
+
+void testEqualValues()
+{
+    testDiag("testEqualValues");
+    pvd::PVStructurePtr A(pvd::getPVDataCreate()->createPVStructure(makeType())),
+                        B(pvd::getPVDataCreate()->createPVStructure(makeType()));
+    fill(A);
+    fill(B);
+
+    pvd::BitSet changed;
+    testOk1(*A==*B);
+    testOk1(pvd::compareValues(*A, *B, changed));
+    testOk1(changed.isEmpty());
+
+    // shared storage
+    B->getSubFieldT<pvd::PVIntArray>("b")->replace(A->getSubFieldT<pvd::PVIntArray>("b")->view());
+    testOk1(*A==*B);
+}
+
+void testChanged()
+{
+    testDiag("testChanged");
+    pvd::PVStructurePtr A(pvd::getPVDataCreate()->createPVStructure(makeType())),
+                        B(pvd::getPVDataCreate()->createPVStructure(makeType()));
+    fill(A);
+    fill(B);
+
+    {
+        pvd::PVIntArrayPtr b(B->getSubFieldT<pvd::PVIntArray>("b"));
+        pvd::PVIntArray::const_svector temp(b->view());
+        pvd::PVIntArray::svector arr(pvd::thaw(temp));
+        arr[99] = -1;
+        b->replace(pvd::freeze(arr));
+    }
+    B->getSubFieldT<pvd::PVString>("c.e")->put("world");
+    B->getSubFieldT<pvd::PVUnion>("g")->set(pvd::getPVDataCreate()->createPVScalar(pvd::pvInt));
+
+    pvd::BitSet changed;
+    testOk1(*A!=*B);
+    testOk1(!pvd::compareValues(*A, *B, changed));
+    testEqual(changed, pvd::BitSet()
+              .set(A->getSubFieldT("b")->getFieldOffset())
+              .set(A->getSubFieldT("c.e")->getFieldOffset())
+              .set(A->getSubFieldT("g")->getFieldOffset()));
+
+    // existing bits are not cleared
+    changed.clear();
+    changed.set(A->getSubFieldT("a")->getFieldOffset());
+    B->getSubFieldT<pvd::PVString>("c.e")->put("hello");
+    testOk1(!pvd::compareValues(*A, *B, changed));
+    testEqual(changed, pvd::BitSet()
+              .set(A->getSubFieldT("a")->getFieldOffset())
+              .set(A->getSubFieldT("b")->getFieldOffset())
+              .set(A->getSubFieldT("g")->getFieldOffset()));
+}
+
+void testArrays()
+{
+    testDiag("testArrays");
+    pvd::PVDoubleArrayPtr A(pvd::getPVDataCreate()->createPVScalarArray<pvd::PVDoubleArray>()),
+                          B(pvd::getPVDataCreate()->createPVScalarArray<pvd::PVDoubleArray>());
+
+    {
+        pvd::PVDoubleArray::svector a(2, 0.0), b(2, -0.0);
+        A->replace(pvd::freeze(a));
+        B->replace(pvd::freeze(b));
+    }
+    testOk(*A==*B, "0.0 == -0.0");
+
+    {
+        pvd::PVDoubleArray::svector a(2, epicsNAN), b(2, epicsNAN);
+        A->replace(pvd::freeze(a));
+        B->replace(pvd::freeze(b));
+    }
+    testOk(*A!=*B, "NaN != NaN");
+
+    A->setLength(1);
+    testOk(*A!=*B, "length differs");
+}
+
+void testDiff()
+{
+    testDiag("testDiff");
+    pvd::PVStructurePtr A(pvd::getPVDataCreate()->createPVStructure(makeType())),
+                        B(pvd::getPVDataCreate()->createPVStructure(makeType()));
+    fill(A);
+    fill(B);
+
+    pvd::BitSet changed;
+    changed.set(1);
+    testOk1(!pvd::diff(*A, *B, changed));
+    testOk1(changed.isEmpty());
+
+    B->getSubFieldT<pvd::PVInt>("a")->put(2);
+    B->getSubFieldT<pvd::PVDouble>("c.d")->put(3.0);
+    testOk1(pvd::diff(*A, *B, changed));
+    testEqual(changed, pvd::BitSet()
+              .set(A->getSubFieldT("a")->getFieldOffset())
+              .set(A->getSubFieldT("c.d")->getFieldOffset()));
+
+    // all sub-fields of 'c' changed, compress to 'c'
+    B->getSubFieldT<pvd::PVString>("c.e")->put("world");
+    pvd::diff(*A, *B, changed);
+    testEqual(changed, pvd::BitSet()
+              .set(A->getSubFieldT("a")->getFieldOffset())
+              .set(A->getSubFieldT("c")->getFieldOffset()));
+
+    // everything changed
+    {
+        pvd::PVIntArray::svector b(1, 5);
+        B->getSubFieldT<pvd::PVIntArray>("b")->replace(pvd::freeze(b));
+        pvd::PVDoubleArray::svector f(1, 5.0);
+        B->getSubFieldT<pvd::PVDoubleArray>("f")->replace(pvd::freeze(f));
+        B->getSubFieldT<pvd::PVUnion>("g")->set(pvd::getPVDataCreate()->createPVScalar(pvd::pvInt));
+    }
+    pvd::diff(*A, *B, changed);
+    testEqual(changed, pvd::BitSet().set(0));
+
+    pvd::PVStructurePtr other(pvd::getPVDataCreate()->createPVStructure(
+                                  pvd::getFieldCreate()->createFieldBuilder()
+                                    ->add("a", pvd::pvInt)
+                                    ->createStructure()));
+    testThrows(std::invalid_argument, pvd::diff(*A, *other, changed));
+}
+
+void testDeadband()
+{
+    testDiag("testDeadband");
+    pvd::PVStructurePtr A(pvd::getPVDataCreate()->createPVStructure(makeType())),
+                        B(pvd::getPVDataCreate()->createPVStructure(makeType()));
+    fill(A);
+    fill(B);
+
+    pvd::DiffDeadband band;
+    band.set(*A, "c.d", 0.5)
+        .set(*A, "f", 0.1);
+
+    B->getSubFieldT<pvd::PVDouble>("c.d")->put(2.4);
+    {
+        pvd::PVDoubleArray::svector f(3, 1.55);
+        B->getSubFieldT<pvd::PVDoubleArray>("f")->replace(pvd::freeze(f));
+    }
+
+    pvd::BitSet changed;
+    testOk1(!pvd::diff(*A, *B, changed, band));
+    testOk1(pvd::diff(*A, *B, changed));
+
+    B->getSubFieldT<pvd::PVDouble>("c.d")->put(2.6);
+    {
+        pvd::PVDoubleArray::svector f(3, 1.55);
+        f[2] = 1.7;
+        B->getSubFieldT<pvd::PVDoubleArray>("f")->replace(pvd::freeze(f));
+    }
+    testOk1(pvd::diff(*A, *B, changed, band));
+    testEqual(changed, pvd::BitSet()
+              .set(A->getSubFieldT("c.d")->getFieldOffset())
+              .set(A->getSubFieldT("f")->getFieldOffset()));
+
+    // length change always reported
+    B->getSubFieldT<pvd::PVDouble>("c.d")->put(2.0);
+    {
+        pvd::PVDoubleArray::svector f(2, 1.5);
+        B->getSubFieldT<pvd::PVDoubleArray>("f")->replace(pvd::freeze(f));
+    }
+    pvd::diff(*A, *B, changed, band);
+    testEqual(changed, pvd::BitSet()
+              .set(A->getSubFieldT("f")->getFieldOffset()));
+}
+
+} // namespace
+
+MAIN(testCompare)
+{
+    testPlan(24);
+    testEqualValues();
+    testChanged();
+    testArrays();
+    testDiff();
+    testDeadband();
+    return testDone();
+}
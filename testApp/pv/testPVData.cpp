@@ -511,6 +511,56 @@ static void testCopy()
     testOk(*pvUnion == *pvUnion2, "PVUnion PVStructure copy, to different type PVUnion");
 }
 
+static void testCopyShares()
+{
+    testDiag("testCopyShares");
+    StructureConstPtr elem(fieldCreate->createFieldBuilder()
+                           ->add("x", pvInt)
+                           ->createStructure());
+    StructureConstPtr type(fieldCreate->createFieldBuilder()
+                           ->addArray("value", pvDouble)
+                           ->addArray("table", elem)
+                           ->addArray("anys", fieldCreate->createVariantUnion())
+                           ->add("any", fieldCreate->createVariantUnion())
+                           ->add("alarm", standardField->alarm())
+                           ->createStructure());
+
+    PVStructurePtr src(pvDataCreate->createPVStructure(type)),
+                   dest(pvDataCreate->createPVStructure(type));
+    {
+        PVDoubleArray::svector arr(1024*128, 1.0);
+        src->getSubFieldT<PVDoubleArray>("value")->replace(freeze(arr));
+    }
+    {
+        PVStructureArray::svector arr(2);
+        arr[0] = pvDataCreate->createPVStructure(elem);
+        src->getSubFieldT<PVStructureArray>("table")->replace(freeze(arr));
+    }
+    {
+        PVUnionArray::svector arr(1);
+        src->getSubFieldT<PVUnionArray>("anys")->replace(freeze(arr));
+    }
+    {
+        PVDoubleArrayPtr arr(pvDataCreate->createPVScalarArray<PVDoubleArray>());
+        arr->replace(src->getSubFieldT<PVDoubleArray>("value")->view());
+        src->getSubFieldT<PVUnion>("any")->set(arr);
+    }
+    src->getSubFieldT<PVInt>("alarm.severity")->put(2);
+
+    dest->copyUnchecked(*src);
+
+    testEqual(*dest, *src);
+    testOk1(dest->getSubFieldT<PVDoubleArray>("value")->view().data()
+            ==src->getSubFieldT<PVDoubleArray>("value")->view().data());
+    testOk1(dest->getSubFieldT<PVStructureArray>("table")->view().data()
+            ==src->getSubFieldT<PVStructureArray>("table")->view().data());
+    testOk1(dest->getSubFieldT<PVUnionArray>("anys")->view().data()
+            ==src->getSubFieldT<PVUnionArray>("anys")->view().data());
+    testOk1(dest->getSubFieldT<PVUnion>("any")->get<PVDoubleArray>()->view().data()
+            ==src->getSubFieldT<PVDoubleArray>("value")->view().data());
+    testEqual(dest->getSubFieldT<PVInt>("alarm.severity")->get(), 2);
+}
+
 static void testFieldAccess()
 {
     testDiag("Check methods for accessing structure fields");
@@ -740,7 +790,7 @@ static void testSubField()
 
 MAIN(testPVData)
 {
-    testPlan(271);
+    testPlan(277);
     try{
         fieldCreate = getFieldCreate();
         pvDataCreate = getPVDataCreate();
@@ -753,6 +803,7 @@ MAIN(testPVData)
         testScalarArray();
         testRequest();
         testCopy();
+        testCopyShares();
         testFieldAccess();
         testAnyScalar();
         testSubField();
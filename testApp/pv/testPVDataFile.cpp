@@ -0,0 +1,214 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/pvData.h>
+#include <pv/pvDataFile.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+const char testFileName[] = "testPVDataFile.tmp";
+
+pvd::PVStructurePtr buildValue()
+{
+    pvd::FieldCreatePtr create(pvd::getFieldCreate());
+    pvd::StructureConstPtr elem(create->createFieldBuilder()
+                                ->add("x", pvd::pvDouble)
+                                ->add("name", pvd::pvString)
+                                ->createStructure());
+    pvd::StructureConstPtr type(create->createFieldBuilder()
+                                ->setId("test_t")
+                                ->add("flag", pvd::pvBoolean)
+                                ->add("i8", pvd::pvByte)
+                                ->add("i64", pvd::pvLong)
+                                ->add("str", pvd::pvString)
+                                ->addArray("bytes", pvd::pvUByte)
+                                ->addArray("wave", pvd::pvDouble)
+                                ->addArray("ints", pvd::pvInt)
+                                ->addArray("names", pvd::pvString)
+                                ->addNestedStructure("sub")
+                                    ->add("f", pvd::pvFloat)
+                                ->endNested()
+                                ->addArray("table", elem)
+                                ->addNestedUnion("choice")
+                                    ->add("a", pvd::pvInt)
+                                    ->add("b", pvd::pvString)
+                                ->endNested()
+                                ->add("any", create->createVariantUnion())
+                                ->add("empty", create->createVariantUnion())
+                                ->addArray("anys", create->createVariantUnion())
+                                ->createStructure());
+
+    pvd::PVStructurePtr val(pvd::getPVDataCreate()->createPVStructure(type));
+    val->getSubFieldT<pvd::PVBoolean>("flag")->put(true);
+    val->getSubFieldT<pvd::PVByte>("i8")->put(-3);
+    val->getSubFieldT<pvd::PVLong>("i64")->put(0x123456789abcll);
+    val->getSubFieldT<pvd::PVString>("str")->put("hello");
+    {
+        pvd::PVUByteArray::svector arr(3);
+        arr[0] = 1; arr[1] = 2; arr[2] = 3;
+        val->getSubFieldT<pvd::PVUByteArray>("bytes")->replace(pvd::freeze(arr));
+    }
+    {
+        pvd::PVDoubleArray::svector arr(1000);
+        for(size_t i=0; i<arr.size(); i++)
+            arr[i] = i*0.5;
+        val->getSubFieldT<pvd::PVDoubleArray>("wave")->replace(pvd::freeze(arr));
+    }
+    {
+        pvd::PVStringArray::svector arr(2);
+        arr[0] = "one"; arr[1] = "";
+        val->getSubFieldT<pvd::PVStringArray>("names")->replace(pvd::freeze(arr));
+    }
+    val->getSubFieldT<pvd::PVFloat>("sub.f")->put(1.5f);
+    {
+        pvd::PVStructureArrayPtr table(val->getSubFieldT<pvd::PVStructureArray>("table"));
+        pvd::PVStructureArray::svector arr(3);
+        arr[0] = pvd::getPVDataCreate()->createPVStructure(elem);
+        arr[0]->getSubFieldT<pvd::PVDouble>("x")->put(4.0);
+        arr[0]->getSubFieldT<pvd::PVString>("name")->put("first");
+        // arr[1] left NULL
+        arr[2] = pvd::getPVDataCreate()->createPVStructure(elem);
+        table->replace(pvd::freeze(arr));
+    }
+    val->getSubFieldT<pvd::PVUnion>("choice")->select<pvd::PVString>("b")->put("bee");
+    {
+        pvd::PVIntArrayPtr ints(pvd::getPVDataCreate()->createPVScalarArray<pvd::PVIntArray>());
+        pvd::PVIntArray::svector arr(2);
+        arr[0] = -1; arr[1] = 7;
+        ints->replace(pvd::freeze(arr));
+        val->getSubFieldT<pvd::PVUnion>("any")->set(ints);
+    }
+    {
+        pvd::PVUnionArrayPtr anys(val->getSubFieldT<pvd::PVUnionArray>("anys"));
+        pvd::PVUnionArray::svector arr(2);
+        arr[0] = pvd::getPVDataCreate()->createPVVariantUnion();
+        arr[0]->set(pvd::getPVDataCreate()->createPVScalar<pvd::PVString>());
+        anys->replace(pvd::freeze(arr));
+    }
+    return val;
+}
+
+void testRoundTrip()
+{
+    testDiag("testRoundTrip");
+    pvd::PVStructurePtr orig(buildValue());
+
+    pvd::saveToFile(*orig, testFileName);
+    pvd::PVStructurePtr loaded(pvd::loadFromFile(testFileName));
+
+    testEqual(loaded->getStructure()->getID(), "test_t");
+    testOk1(loaded->getStructure()==orig->getStructure());
+    testEqual(*loaded, *orig);
+
+    pvd::PVDoubleArray::const_svector wave(loaded->getSubFieldT<pvd::PVDoubleArray>("wave")->view());
+    testEqual(wave.size(), 1000u);
+    testOk((size_t(wave.data())%16)==0, "array data aligned");
+    testEqual(wave[999], 499.5);
+    testOk1(!loaded->getSubFieldT<pvd::PVStructureArray>("table")->view()[1]);
+    testEqual(loaded->getSubFieldT<pvd::PVUnion>("choice")->getSelectedFieldName(), "b");
+    testOk1(!loaded->getSubFieldT<pvd::PVUnion>("empty")->get());
+}
+
+void testModify()
+{
+    testDiag("testModify");
+    pvd::PVStructurePtr orig(buildValue());
+
+    pvd::saveToFile(*orig, testFileName);
+    {
+        pvd::PVStructurePtr loaded(pvd::loadFromFile(testFileName));
+        pvd::PVDoubleArrayPtr wave(loaded->getSubFieldT<pvd::PVDoubleArray>("wave"));
+        // array is unique, so this modifies in place
+        pvd::PVDoubleArray::svector arr(wave->reuse());
+        arr[0] = 42.0;
+        wave->replace(pvd::freeze(arr));
+        testEqual(wave->view()[0], 42.0);
+
+        // mapping remains valid after the structure is released
+        pvd::PVDoubleArray::const_svector keep(wave->view());
+        loaded.reset();
+        wave.reset();
+        testEqual(keep[1], 0.5);
+    }
+    // file unchanged
+    pvd::PVStructurePtr again(pvd::loadFromFile(testFileName));
+    testEqual(*again, *orig);
+}
+
+void testOverwrite()
+{
+    testDiag("testOverwrite");
+    pvd::PVStructurePtr orig(buildValue());
+
+    pvd::saveToFile(*orig, testFileName);
+    pvd::PVStructurePtr loaded(pvd::loadFromFile(testFileName));
+
+    // replace the file while its arrays are still referenced
+    pvd::PVStructurePtr next(buildValue());
+    {
+        pvd::PVDoubleArray::svector arr(2000, 1.0);
+        next->getSubFieldT<pvd::PVDoubleArray>("wave")->replace(pvd::freeze(arr));
+    }
+    pvd::saveToFile(*loaded, testFileName); // save back to the same path
+    pvd::saveToFile(*next, testFileName);
+
+    pvd::PVDoubleArray::const_svector wave(loaded->getSubFieldT<pvd::PVDoubleArray>("wave")->view());
+    testEqual(wave.size(), 1000u);
+    testEqual(wave[999], 499.5);
+    testEqual(*loaded, *orig);
+
+    pvd::PVStructurePtr again(pvd::loadFromFile(testFileName));
+    testEqual(*again, *next);
+}
+
+void testErrors()
+{
+    testDiag("testErrors");
+    remove(testFileName);
+    testThrows(std::runtime_error, pvd::loadFromFile(testFileName));
+    {
+        std::ofstream strm(testFileName);
+        strm<<"not a pvData file";
+    }
+    testThrows(std::runtime_error, pvd::loadFromFile(testFileName));
+
+    pvd::saveToFile(*buildValue(), testFileName);
+    {
+        // truncate
+        std::ifstream in(testFileName, std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        in.close();
+        std::ofstream out(testFileName, std::ios::binary|std::ios::trunc);
+        out.write(content.c_str(), content.size()/2);
+    }
+    testThrows(std::runtime_error, pvd::loadFromFile(testFileName));
+    remove(testFileName);
+}
+
+} // namespace
+
+MAIN(testPVDataFile)
+{
+    testPlan(19);
+    try {
+        testRoundTrip();
+        testModify();
+        testOverwrite();
+        testErrors();
+    }catch(std::exception& e){
+        testAbort("Unexpected exception: %s", e.what());
+    }
+    return testDone();
+}
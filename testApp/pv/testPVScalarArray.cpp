@@ -16,8 +16,10 @@
 #include <epicsUnitTest.h>
 #include <testMain.h>
 
+#include <pv/pvUnitTest.h>
 #include <pv/pvIntrospect.h>
 #include <pv/pvData.h>
+#include <pv/serialize.h>
 #include <pv/convert.h>
 #include <pv/standardField.h>
 #include <pv/standardPVField.h>
@@ -196,11 +198,282 @@ static void testVoid()
     testOk1(iarr->getLength()==4);
 }
 
+static void testInline()
+{
+    testDiag("Check small arrays stored inline");
+
+    PVDoubleArrayPtr darr = static_pointer_cast<PVDoubleArray>(getPVDataCreate()->createPVScalarArray(pvDouble));
+    PVDoubleArrayPtr other = static_pointer_cast<PVDoubleArray>(getPVDataCreate()->createPVScalarArray(pvDouble));
+
+    darr->setLength(3);
+    testOk1(darr->getLength()==3);
+    testOk1(darr->view().size()==3 && darr->view()[2]==0.0);
+
+    PVDoubleArray::svector data(4);
+    for(size_t i=0; i<data.size(); i++)
+        data[i] = i+1.0;
+    other->replace(freeze(data));
+
+    std::vector<epicsUInt8> buf, buf2;
+    serializeToVector(other.get(), EPICS_BYTE_ORDER, buf);
+    deserializeFromVector(darr.get(), EPICS_BYTE_ORDER, buf);
+
+    testOk1(darr->getLength()==4);
+    PVDoubleArray::const_svector V(darr->view());
+    testOk1(V.size()==4 && V[0]==1.0 && V[3]==4.0);
+    testOk1(V.unique()); // a copy
+    testOk1(darr->getCapacity()==8u); // view() leaves the data inline
+
+    {
+        // copies are also inline, without allocating
+        PVDoubleArrayPtr A = static_pointer_cast<PVDoubleArray>(getPVDataCreate()->createPVScalarArray(pvDouble));
+        A->copyUnchecked(*darr);
+        testOk1(A->getLength()==4 && A->getCapacity()==8u);
+        testOk1(A->view()==V);
+    }
+
+    serializeToVector(darr.get(), EPICS_BYTE_ORDER, buf2);
+    testOk1(buf==buf2);
+
+    // grow beyond inline storage
+    darr->setLength(20);
+    V = darr->view();
+    testOk1(V.size()==20 && V[3]==4.0);
+    testOk1(!V.unique()); // shared with darr
+
+    // convert into inline storage
+    PVIntArray::const_svector idata(2, 7);
+    darr->PVScalarArray::putFrom<int32>(idata);
+    testOk1(darr->getLength()==2 && darr->view()[1]==7.0);
+}
+
+static void testDeserializeReuse()
+{
+    testDiag("Check deserialize() re-use of array storage");
+
+    PVDoubleArrayPtr darr = static_pointer_cast<PVDoubleArray>(getPVDataCreate()->createPVScalarArray(pvDouble));
+    PVDoubleArrayPtr other = static_pointer_cast<PVDoubleArray>(getPVDataCreate()->createPVScalarArray(pvDouble));
+
+    PVDoubleArray::svector data(100, 1.0);
+    other->replace(freeze(data));
+    std::vector<epicsUInt8> buf;
+    serializeToVector(other.get(), EPICS_BYTE_ORDER, buf);
+
+    PVDoubleArray::svector initial(100, 2.0);
+    darr->replace(freeze(initial));
+
+    // not referenced elsewhere, so re-used
+    const double *prev = darr->view().data();
+    deserializeFromVector(darr.get(), EPICS_BYTE_ORDER, buf);
+    testOk1(darr->view().data()==prev && darr->view()[99]==1.0);
+
+    // referenced elsewhere, so left unchanged
+    PVDoubleArray::const_svector held(darr->view());
+    PVDoubleArray::svector next(100, 3.0);
+    other->replace(freeze(next));
+    buf.clear();
+    serializeToVector(other.get(), EPICS_BYTE_ORDER, buf);
+    deserializeFromVector(darr.get(), EPICS_BYTE_ORDER, buf);
+    testOk1(darr->view().data()!=held.data() && darr->view()[99]==3.0);
+    testOk1(held.unique() && held[99]==1.0);
+
+    PVStringArrayPtr sarr = static_pointer_cast<PVStringArray>(getPVDataCreate()->createPVScalarArray(pvString));
+    PVStringArrayPtr sother = static_pointer_cast<PVStringArray>(getPVDataCreate()->createPVScalarArray(pvString));
+    PVStringArray::svector sdata(3, "new");
+    sother->replace(freeze(sdata));
+    buf.clear();
+    serializeToVector(sother.get(), EPICS_BYTE_ORDER, buf);
+
+    PVStringArray::svector sinitial(3, "old");
+    sarr->replace(freeze(sinitial));
+    PVStringArray::const_svector sheld(sarr->view());
+    deserializeFromVector(sarr.get(), EPICS_BYTE_ORDER, buf);
+    testOk1(sarr->view().size()==3 && sarr->view()[2]=="new");
+    testOk1(sheld.unique() && sheld[2]=="old");
+}
+
+template<typename PVT>
+static void testAppend()
+{
+    testDiag("Check append() of segments for %s", ScalarTypeFunc::name(PVT::typeCode));
+    typedef typename PVT::value_type value_type;
+    typedef typename PVT::const_svector const_svector;
+
+    typename PVT::shared_pointer arr = static_pointer_cast<PVT>(getPVDataCreate()->createPVScalarArray(PVT::typeCode));
+    typename PVT::shared_pointer flat = static_pointer_cast<PVT>(getPVDataCreate()->createPVScalarArray(PVT::typeCode));
+
+    // large enough that append() does not join segments
+    const size_t N = chunked_vector<value_type>::coalesce_bytes;
+    typename PVT::svector all(3*N);
+    for(size_t i=0; i<all.size(); i++)
+        all[i] = castUnsafe<value_type>(i);
+    const_svector call(freeze(all));
+
+    const_svector A(call), B(call), C(call);
+    A.slice(0, N);
+    B.slice(N, N);
+    C.slice(2*N);
+
+    arr->replace(A);
+    arr->append(B);
+    arr->append(C);
+    testOk1(arr->getLength()==3*N);
+    testOk1(arr->segments().nsegments()==3);
+    testOk1(arr->segments().begin()->data()==call.data()); // not copied
+
+    flat->replace(call);
+    std::vector<epicsUInt8> buf, buf2;
+    serializeToVector(arr.get(), EPICS_BYTE_ORDER, buf);
+    serializeToVector(flat.get(), EPICS_BYTE_ORDER, buf2);
+    testOk1(buf==buf2);
+
+    // sub-range spanning segment boundaries
+    arr->dropFront(8);
+    flat->dropFront(8);
+    arr->dropBack(14);
+    flat->dropBack(14);
+    testOk1(arr->getLength()==3*N-22 && flat->getLength()==3*N-22);
+    testOk1(arr->segments().nsegments()==3);
+    {
+        std::vector<epicsUInt8> buf3, buf4;
+        serializeToVector(arr.get(), EPICS_BYTE_ORDER, buf3);
+        serializeToVector(flat.get(), EPICS_BYTE_ORDER, buf4);
+        testOk1(buf3==buf4);
+    }
+
+    const_svector V(arr->view());
+    testOk1(V.size()==3*N-22 && V[0]==castUnsafe<value_type>(8) && V[3*N-23]==castUnsafe<value_type>(3*N-15));
+    // view() does not change the segments
+    testOk1(arr->segments().nsegments()==3);
+    {
+        // a copy shares segments
+        typename PVT::shared_pointer copy = static_pointer_cast<PVT>(getPVDataCreate()->createPVScalarArray(PVT::typeCode));
+        copy->copyUnchecked(*arr);
+        testOk1(copy->segments().nsegments()==3);
+        testOk1(copy->segments().begin()->data()==arr->segments().begin()->data());
+        testOk1(copy->view()==V);
+    }
+
+    // segments joined once
+    arr->flatten();
+    testOk1(arr->segments().empty());
+    testOk1(arr->view()==V);
+    testOk1(arr->view().data()==arr->view().data());
+
+    // deserialize replaces segments
+    arr->append(B);
+    deserializeFromVector(arr.get(), EPICS_BYTE_ORDER, buf);
+    testOk1(arr->segments().empty());
+    testOk1(arr->view()==call);
+
+    // small appends are joined
+    arr->replace(const_svector());
+    for(size_t i=0; i<100; i++)
+        arr->append(const_svector(1, castUnsafe<value_type>(i)));
+    testOk1(arr->getLength()==100);
+    testOk1(arr->segments().nsegments()==1);
+    testOk1(arr->view()[99]==castUnsafe<value_type>(99));
+}
+
+template<typename PVT>
+static void testCircular()
+{
+    testDiag("Check circular array for %s", ScalarTypeFunc::name(PVT::typeCode));
+    typedef typename PVT::value_type value_type;
+    typedef typename PVT::const_svector const_svector;
+
+    typename PVT::shared_pointer arr = static_pointer_cast<PVT>(getPVDataCreate()->createPVScalarArray(PVT::typeCode));
+    typename PVT::shared_pointer flat = static_pointer_cast<PVT>(getPVDataCreate()->createPVScalarArray(PVT::typeCode));
+
+    testThrows(std::logic_error, arr->push(value_type()));
+
+    typename PVT::svector init(3);
+    for(size_t i=0; i<init.size(); i++)
+        init[i] = castUnsafe<value_type>(i);
+    arr->replace(freeze(init));
+
+    arr->setCircular(5);
+    testOk1(arr->isCircular());
+    testOk1(arr->getLength()==3 && arr->getCapacity()==5);
+
+    for(size_t i=3; i<8; i++)
+        arr->push(castUnsafe<value_type>(i));
+    // 3 ... 7, wrapped around
+    testOk1(arr->getLength()==5);
+
+    const_svector first, second;
+    arr->spans(first, second);
+    testOk1(first.size()==2 && first[0]==castUnsafe<value_type>(3));
+    testOk1(second.size()==3 && second[2]==castUnsafe<value_type>(7));
+
+    typename PVT::svector expect(5);
+    for(size_t i=0; i<expect.size(); i++)
+        expect[i] = castUnsafe<value_type>(i+3);
+    const_svector cexpect(freeze(expect));
+    testOk1(arr->view()==cexpect);
+
+    // wire format is that of an ordinary array
+    flat->replace(cexpect);
+    {
+        std::vector<epicsUInt8> buf, buf2;
+        serializeToVector(arr.get(), EPICS_BYTE_ORDER, buf);
+        serializeToVector(flat.get(), EPICS_BYTE_ORDER, buf2);
+        testOk1(buf==buf2);
+    }
+
+    // push() after spans() are released does not disturb a held view()
+    first.clear();
+    second.clear();
+    const_svector held(arr->view());
+    arr->push(castUnsafe<value_type>(8));
+    testOk1(held==cexpect);
+    testOk1(arr->view()[4]==castUnsafe<value_type>(8));
+
+    {
+        // address of logical element i
+        struct addr {
+            static const value_type* at(const const_svector& A, const const_svector& B, size_t i)
+            { return i<A.size() ? A.data()+i : B.data()+(i-A.size()); }
+        };
+        const_svector A, B, C, D;
+
+        // not referenced, so push() does not copy.  the second oldest becomes the oldest
+        arr->spans(A, B);
+        const value_type *second = addr::at(A, B, 1);
+        A.clear();
+        B.clear();
+        arr->push(castUnsafe<value_type>(9));
+        arr->spans(C, D);
+        testOk1(addr::at(C, D, 0)==second);
+        C.clear();
+        D.clear();
+
+        // referenced, so the first push() copies, leaving the reference unchanged
+        arr->spans(A, B);
+        second = addr::at(A, B, 1);
+        arr->push(castUnsafe<value_type>(10));
+        arr->spans(C, D);
+        testOk1(addr::at(C, D, 0)!=second);
+        testOk1(*addr::at(A, B, 4)==castUnsafe<value_type>(9));
+        testOk1(*addr::at(C, D, 4)==castUnsafe<value_type>(10));
+    }
+
+    arr->append(cexpect); // 3 ... 7 again
+    testOk1(arr->view()==cexpect);
+
+    arr->setCapacity(2);
+    testOk1(arr->getLength()==2 && arr->view()[0]==castUnsafe<value_type>(6));
+
+    arr->setCircular(0);
+    testOk1(!arr->isCircular());
+    testOk1(arr->getLength()==2 && arr->view()[1]==castUnsafe<value_type>(7));
+}
+
 } // end namespace
 
 MAIN(testPVScalarArray)
 {
-    testPlan(158);
+    testPlan(289);
     testFactory();
     testBasic<PVByteArray>();
     testBasic<PVUByteArray>();
@@ -209,5 +482,13 @@ MAIN(testPVScalarArray)
     testBasic<PVStringArray>();
     testShare();
     testVoid();
+    testInline();
+    testDeserializeReuse();
+    testAppend<PVUByteArray>();
+    testAppend<PVDoubleArray>();
+    testAppend<PVStringArray>();
+    testCircular<PVDoubleArray>();
+    testCircular<PVIntArray>();
+    testCircular<PVStringArray>();
     return testDone();
 }
@@ -16,6 +16,8 @@
 
 #include <pv/pvIntrospect.h>
 #include <pv/pvData.h>
+#include <pv/serialize.h>
+#include <pv/pvUnitTest.h>
 #include <pv/convert.h>
 #include <pv/standardField.h>
 #include <pv/standardPVField.h>
@@ -155,9 +157,187 @@ static void testFromRaw()
     PVStructureArray::svector cont(raw, 1, 2);
 }
 
+static void testColumnar()
+{
+    testDiag("Test columnar storage");
+
+    StructureConstPtr type(fieldCreate->createFieldBuilder()
+                           ->add("a", pvInt)
+                           ->add("b", pvDouble)
+                           ->add("c", pvString)
+                           ->createStructure());
+    StructureArrayConstPtr arrtype(fieldCreate->createStructureArray(type));
+
+    PVStructureArrayPtr arr(pvDataCreate->createPVStructureArray(arrtype));
+    arr->append(3);
+    {
+        PVStructureArray::const_svector V(arr->view());
+        for(size_t i=0; i<V.size(); i++) {
+            V[i]->getSubFieldT<PVInt>("a")->put(int32(i));
+            V[i]->getSubFieldT<PVDouble>("b")->put(i+0.5);
+            V[i]->getSubFieldT<PVString>("c")->put(std::string(1, char('x'+i)));
+        }
+    }
+
+    std::vector<epicsUInt8> rowbuf;
+    serializeToVector(arr.get(), EPICS_BYTE_ORDER, rowbuf);
+
+    arr->setColumnar(true);
+    testOk1(arr->isColumnar());
+    testOk1(arr->getLength()==3);
+    testOk1(arr->getColumns().size()==3);
+
+    shared_vector<const int32> A(static_shared_vector_cast<const int32>(arr->getColumns()[0]));
+    shared_vector<const std::string> C(static_shared_vector_cast<const std::string>(arr->getColumns()[2]));
+    testOk1(A.size()==3 && A[2]==2);
+    testOk1(C.size()==3 && C[1]=="y");
+
+    {
+        std::vector<epicsUInt8> colbuf;
+        serializeToVector(arr.get(), EPICS_BYTE_ORDER, colbuf);
+        testOk1(colbuf==rowbuf);
+    }
+
+    PVStructurePtr row(arr->getRow(1));
+    testOk1(row->getSubFieldT<PVDouble>("b")->get()==1.5);
+    testOk1(arr->view()[2]->getSubFieldT<PVString>("c")->get()=="z");
+
+    // deserialize into columns
+    PVStructureArrayPtr other(pvDataCreate->createPVStructureArray(arrtype));
+    other->setColumnar(true);
+    deserializeFromVector(other.get(), EPICS_BYTE_ORDER, rowbuf);
+    testOk1(other->isColumnar());
+    testOk1(other->getLength()==3);
+    testOk1(*other->getRow(2)==*arr->getRow(2));
+
+    // NULL elements return to storage as PVStructure s
+    {
+        PVStructureArrayPtr withnull(pvDataCreate->createPVStructureArray(arrtype));
+        PVStructureArray::svector V(3);
+        V[0] = arr->getRow(0);
+        V[2] = arr->getRow(2);
+        withnull->replace(freeze(V));
+        testThrows(std::invalid_argument, withnull->setColumnar(true));
+
+        std::vector<epicsUInt8> nullbuf;
+        serializeToVector(withnull.get(), EPICS_BYTE_ORDER, nullbuf);
+        deserializeFromVector(other.get(), EPICS_BYTE_ORDER, nullbuf);
+        testOk1(!other->isColumnar());
+        testOk1(other->getLength()==3);
+        testOk1(other->view()[0] && !other->view()[1] && other->view()[2]);
+        testOk1(*other->view()[2]==*arr->getRow(2));
+    }
+
+    // putColumns()
+    PVStructureArray::columns_t cols(arr->getColumns());
+    testThrows(std::invalid_argument, other->putColumns(PVStructureArray::columns_t(2)));
+    std::swap(cols[0], cols[1]);
+    testThrows(std::invalid_argument, other->putColumns(cols));
+    std::swap(cols[0], cols[1]);
+    other->putColumns(cols);
+    testOk1(other->isColumnar());
+    testOk1(other->getColumns()[1].data()==arr->getColumns()[1].data()); // not copied
+
+    // changes return to storage as PVStructure s
+    arr->append(1);
+    testOk1(!arr->isColumnar());
+    testOk1(arr->getLength()==4);
+    testOk1(arr->view()[1]->getSubFieldT<PVInt>("a")->get()==1);
+
+    // only scalar fields
+    PVStructureArrayPtr nested(pvDataCreate->createPVStructureArray(
+                                   fieldCreate->createStructureArray(standardField->scalarArray(pvDouble, ""))));
+    testThrows(std::invalid_argument, nested->setColumnar(true));
+}
+
+static void testBatch()
+{
+    testDiag("Test batched append and remove");
+
+    StructureConstPtr type(standardField->alarm());
+    PVStructureArrayPtr arr(pvDataCreate->createPVStructureArray(type));
+
+    PVStructurePtr proto(pvDataCreate->createPVStructure(type));
+    proto->getSubFieldT<PVString>("message")->put("hello");
+
+    testOk1(arr->append(5, proto)==5);
+    testOk1(arr->view()[4]->getSubFieldT<PVString>("message")->get()=="hello");
+    testOk1(arr->view()[4]!=proto); // a copy
+    testThrows(std::invalid_argument, arr->append(1, standardPVField->scalar(pvDouble, "")));
+
+    {
+        PVStructureArray::const_svector V(arr->view());
+        for(size_t i=0; i<V.size(); i++)
+            V[i]->getSubFieldT<PVInt>("severity")->put(int32(i));
+    }
+
+    PVStructureArray::svector more(3);
+    for(size_t i=0; i<more.size(); i++) {
+        more[i] = pvDataCreate->createPVStructure(type);
+        more[i]->getSubFieldT<PVInt>("severity")->put(int32(5+i));
+    }
+    PVStructureArray::const_svector cmore(freeze(more));
+    testOk1(arr->append(cmore)==8);
+    testOk1(arr->view()[5]==cmore[0]); // not copied
+
+    {
+        // elements of another type are rejected, leaving the array unchanged
+        PVStructureArray::svector bad(2);
+        bad[1] = standardPVField->scalar(pvDouble, "");
+        testThrows(std::invalid_argument, arr->append(freeze(bad)));
+        PVStructureArray::svector badpool(1, standardPVField->scalar(pvDouble, ""));
+        testThrows(std::invalid_argument, arr->append(1, badpool));
+        testOk1(arr->getLength()==8 && badpool.size()==1);
+    }
+
+    // capacity grows geometrically
+    testOk1(arr->getCapacity()>=10);
+
+    // remove scattered elements, in any order
+    std::vector<size_t> idx;
+    idx.push_back(6);
+    idx.push_back(1);
+    idx.push_back(3);
+    idx.push_back(1);
+    PVStructureArray::svector pool;
+    testOk1(arr->remove(idx, pool));
+    testOk1(arr->getLength()==5);
+    testOk1(pool.size()==2); // cmore[1] is still referenced by 'cmore'
+    {
+        PVStructureArray::const_svector V(arr->view());
+        testOk1(V[0]->getSubFieldT<PVInt>("severity")->get()==0
+                && V[1]->getSubFieldT<PVInt>("severity")->get()==2
+                && V[2]->getSubFieldT<PVInt>("severity")->get()==4
+                && V[3]->getSubFieldT<PVInt>("severity")->get()==5
+                && V[4]->getSubFieldT<PVInt>("severity")->get()==7);
+    }
+    idx.clear();
+    idx.push_back(5);
+    testOk1(!arr->remove(idx));
+
+    // range remove to pool, then re-use
+    testOk1(arr->remove(0, 2, pool));
+    testOk1(arr->getLength()==3 && pool.size()==4);
+
+    PVStructurePtr reused(pool.back());
+    testOk1(arr->append(5, pool)==8);
+    testOk1(pool.empty());
+    testOk1(arr->view()[3]==reused);
+    testOk1(arr->view()[7] && arr->view()[7]->getSubFieldT<PVString>("message")->get()=="");
+
+    // compress
+    {
+        PVStructureArray::svector V(3);
+        V[1] = pvDataCreate->createPVStructure(type);
+        arr->replace(freeze(V));
+    }
+    arr->compress();
+    testOk1(arr->getLength()==1 && arr->view()[0]);
+}
+
 MAIN(testPVStructureArray)
 {
-    testPlan(23);
+    testPlan(69);
     testDiag("Testing structure array handling");
     fieldCreate = getFieldCreate();
     pvDataCreate = getPVDataCreate();
@@ -167,5 +347,7 @@ MAIN(testPVStructureArray)
     testCompress();
     testRemove();
     testFromRaw();
+    testColumnar();
+    testBatch();
     return testDone();
 }
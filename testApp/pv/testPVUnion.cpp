@@ -20,6 +20,7 @@
 #include <pv/standardPVField.h>
 #include <pv/timeStamp.h>
 #include <pv/pvTimeStamp.h>
+#include <pv/pvUnitTest.h>
 
 using namespace epics::pvData;
 using std::tr1::static_pointer_cast;
@@ -195,12 +196,53 @@ static void testClearUnion()
     }
 }
 
+static void testUnionArrayBatch()
+{
+    testDiag("testUnionArrayBatch");
+    PVUnionArrayPtr arr(pvDataCreate->createPVUnionArray(fieldCreate->createVariantUnion()));
+
+    PVUnionPtr proto(pvDataCreate->createPVUnion(fieldCreate->createVariantUnion()));
+    proto->set(pvDataCreate->createPVScalar(pvInt));
+
+    testOk1(arr->append(4, proto)==4);
+    testOk1(arr->view()[3]->get() && arr->view()[3]!=proto);
+
+    std::vector<size_t> idx;
+    idx.push_back(2);
+    idx.push_back(0);
+    PVUnionArray::svector pool;
+    testOk1(arr->remove(idx, pool));
+    testOk1(arr->getLength()==2 && pool.size()==2);
+
+    testOk1(arr->append(3, pool)==5);
+    testOk1(pool.empty());
+
+    {
+        // elements of another type are rejected
+        UnionConstPtr other(fieldCreate->createFieldBuilder()
+                            ->add("a", pvInt)
+                            ->createUnion());
+        PVUnionArray::svector bad(1, pvDataCreate->createPVUnion(other)),
+                              badpool(1, pvDataCreate->createPVUnion(other));
+        testThrows(std::invalid_argument, arr->append(freeze(bad)));
+        testThrows(std::invalid_argument, arr->append(1, badpool));
+        testOk1(arr->getLength()==5 && badpool.size()==1);
+    }
+
+    PVUnionArray::svector V(3);
+    V[2] = proto;
+    arr->replace(freeze(V));
+    arr->compress();
+    testOk1(arr->getLength()==1 && arr->view()[0]==proto);
+}
+
 MAIN(testPVUnion)
 {
-    testPlan(21);
+    testPlan(31);
     testPVUnionType();
     testPVUnionArray();
     testClearUnion();
+    testUnionArrayBatch();
     return testDone();
 }
 
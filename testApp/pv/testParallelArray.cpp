@@ -0,0 +1,213 @@
+/*
+ * Copyright information and license terms for this software can be
+ * found in the file LICENSE that is included with the distribution
+ */
+
+#include <stdexcept>
+
+#include <epicsUnitTest.h>
+#include <testMain.h>
+
+#include <pv/pvData.h>
+#include <pv/byteBuffer.h>
+#include <pv/serialize.h>
+#include <pv/parallel.h>
+#include <pv/parallelArray.h>
+#include <pv/pvUnitTest.h>
+
+namespace pvd = epics::pvData;
+
+namespace {
+
+pvd::StructureConstPtr elementType()
+{
+    return pvd::getFieldCreate()->createFieldBuilder()
+            ->add("a", pvd::pvInt)
+            ->add("b", pvd::pvString)
+            ->addArray("c", pvd::pvDouble)
+            ->add("d", pvd::getFieldCreate()->createVariantUnion())
+            ->createStructure();
+}
+
+pvd::PVStructureArrayPtr makeArray(size_t count)
+{
+    pvd::StructureConstPtr type(elementType());
+    pvd::PVStructureArrayPtr arr(pvd::getPVDataCreate()->createPVStructureArray(type));
+
+    pvd::PVStructureArray::svector elements(count);
+    for(size_t i=0; i<count; i++) {
+        if(i%7==3)
+            continue; // leave some NULL
+        elements[i] = pvd::getPVDataCreate()->createPVStructure(type);
+        elements[i]->getSubFieldT<pvd::PVInt>("a")->put(int(i));
+        elements[i]->getSubFieldT<pvd::PVString>("b")->put(i%2 ? "odd" : "even");
+        pvd::PVDoubleArray::svector c(i%5, 1.5);
+        elements[i]->getSubFieldT<pvd::PVDoubleArray>("c")->replace(pvd::freeze(c));
+        if(i%3==0) {
+            pvd::PVIntPtr v(pvd::getPVDataCreate()->createPVScalar<pvd::PVInt>());
+            v->put(int(i));
+            elements[i]->getSubFieldT<pvd::PVUnion>("d")->set(v);
+        }
+    }
+    arr->replace(pvd::freeze(elements));
+    return arr;
+}
+
+// serialize to a buffer large enough for the whole value
+struct FixedControl : public pvd::SerializableControl {
+    virtual void flushSerializeBuffer() { throw std::logic_error("Unexpected flush"); }
+    virtual void ensureBuffer(std::size_t) {}
+    virtual void alignBuffer(std::size_t) {}
+    virtual bool directSerialize(pvd::ByteBuffer *, const char*, std::size_t, std::size_t) { return false; }
+    virtual void cachedSerialize(std::tr1::shared_ptr<const pvd::Field> const & field, pvd::ByteBuffer* buf)
+    { field->serialize(buf, this); }
+};
+
+size_t actualSize(const pvd::PVField& value)
+{
+    pvd::ByteBuffer buf(1024*1024);
+    FixedControl ctrl;
+    value.serialize(&buf, &ctrl);
+    return buf.getPosition();
+}
+
+void testCopy(pvd::ParallelExecutor *exec)
+{
+    testDiag("testCopy concurrency=%u", exec ? unsigned(exec->concurrency()) : 0u);
+
+    pvd::PVStructureArrayPtr src(makeArray(3000)),
+                             dest(pvd::getPVDataCreate()->createPVStructureArray(elementType()));
+
+    pvd::copyElements(*dest, *src, exec);
+
+    pvd::PVStructureArray::const_svector S(src->view()), D(dest->view());
+    testEqual(D.size(), S.size());
+    testOk1(*dest==*src);
+
+    bool distinct = true, nulls = true;
+    for(size_t i=0; i<S.size(); i++) {
+        if(!S[i] || !D[i])
+            nulls &= !S[i] && !D[i];
+        else
+            distinct &= S[i]!=D[i];
+    }
+    testOk(distinct, "elements are copied, not shared");
+    testOk1(nulls);
+
+    // modifying the copy leaves the original unchanged
+    D[1]->getSubFieldT<pvd::PVInt>("a")->put(-1);
+    testEqual(S[1]->getSubFieldT<pvd::PVInt>("a")->get(), 1);
+}
+
+void testCopyUnion()
+{
+    testDiag("testCopyUnion");
+
+    pvd::UnionConstPtr type(pvd::getFieldCreate()->createVariantUnion());
+    pvd::PVUnionArrayPtr src(pvd::getPVDataCreate()->createPVUnionArray(type)),
+                         dest(pvd::getPVDataCreate()->createPVUnionArray(type));
+
+    pvd::PVUnionArray::svector elements(1000);
+    for(size_t i=0; i<elements.size(); i++) {
+        elements[i] = pvd::getPVDataCreate()->createPVUnion(type);
+        pvd::PVDoublePtr v(pvd::getPVDataCreate()->createPVScalar<pvd::PVDouble>());
+        v->put(double(i));
+        elements[i]->set(v);
+    }
+    src->replace(pvd::freeze(elements));
+
+    pvd::copyElements(*dest, *src);
+    testOk1(*dest==*src);
+    testOk1(dest->view()[0]!=src->view()[0]);
+    testOk1(pvd::equalElements(*dest, *src));
+    testEqual(pvd::serializedSize(*src), actualSize(*src));
+}
+
+void testCopyMismatch()
+{
+    testDiag("testCopyMismatch");
+
+    pvd::PVStructureArrayPtr src(makeArray(10)),
+                             dest(pvd::getPVDataCreate()->createPVStructureArray(
+                                      pvd::getFieldCreate()->createFieldBuilder()
+                                      ->add("x", pvd::pvInt)
+                                      ->createStructure()));
+
+    testThrows(std::invalid_argument, pvd::copyElements(*dest, *src));
+}
+
+void testEqualElements(pvd::ParallelExecutor *exec)
+{
+    testDiag("testEqualElements concurrency=%u", exec ? unsigned(exec->concurrency()) : 0u);
+
+    pvd::PVStructureArrayPtr A(makeArray(3000)), B(makeArray(3000));
+
+    testOk1(pvd::equalElements(*A, *B, exec));
+
+    // differ near the end, in a later part
+    B->view()[2990]->getSubFieldT<pvd::PVString>("b")->put("different");
+    testOk1(!pvd::equalElements(*A, *B, exec));
+    testOk1(!(*A==*B));
+
+    pvd::PVStructureArrayPtr C(makeArray(2999));
+    testOk1(!pvd::equalElements(*A, *C, exec));
+
+    // shared storage
+    C->copyUnchecked(*A);
+    testOk1(pvd::equalElements(*A, *C, exec));
+}
+
+void testSize(pvd::ParallelExecutor *exec)
+{
+    testDiag("testSize concurrency=%u", exec ? unsigned(exec->concurrency()) : 0u);
+
+    pvd::PVStructureArrayPtr A(makeArray(3000)), B(makeArray(10)), C(makeArray(0));
+
+    testEqual(pvd::serializedSize(*A, exec), actualSize(*A));
+    testEqual(pvd::serializedSize(*B, exec), actualSize(*B));
+    testEqual(pvd::serializedSize(*C, exec), actualSize(*C));
+}
+
+struct Failing : public pvd::ParallelWork {
+    virtual ~Failing() {}
+    virtual void run(size_t part)
+    {
+        if(part==5)
+            throw std::runtime_error("oops");
+    }
+};
+
+void testExecutorError()
+{
+    testDiag("testExecutorError");
+
+    pvd::ParallelExecutor::shared_pointer exec(pvd::ParallelExecutor::create(2));
+    testEqual(exec->concurrency(), 3u);
+
+    Failing work;
+    testThrows(std::runtime_error, exec->execute(20, work));
+
+    // usable afterwards
+    pvd::PVStructureArrayPtr A(makeArray(1000)), B(makeArray(1000));
+    testOk1(pvd::equalElements(*A, *B, exec.get()));
+}
+
+} // namespace
+
+MAIN(testParallelArray)
+{
+    testPlan(39);
+    pvd::ParallelExecutor::shared_pointer serial(pvd::ParallelExecutor::create(0)),
+                                          threads(pvd::ParallelExecutor::create(3));
+    testCopy(serial.get());
+    testCopy(threads.get());
+    testCopy(0);
+    testCopyUnion();
+    testCopyMismatch();
+    testEqualElements(serial.get());
+    testEqualElements(threads.get());
+    testSize(serial.get());
+    testSize(threads.get());
+    testExecutorError();
+    return testDone();
+}
@@ -28,6 +28,10 @@ int testThread(void);
 int testEvent(void);
 int testTimeStamp(void);
 int testTimer(void);
+int testThreadPool(void);
+int testRingBuffer(void);
+int testLatency(void);
+int testAllocStats(void);
 int testTypeCast(void);
 
 /* property */
@@ -35,11 +39,14 @@ int testCreateRequest(void);
 
 /* pv */
 int testBitSetUtil(void);
+int testCompare(void);
 int testConvert(void);
 int testFieldBuilder(void);
 int testIntrospect(void);
 int testOperators(void);
 int testPVData(void);
+int testPVDataFile(void);
+int testParallelArray(void);
 int testPVScalarArray(void);
 int testPVStructureArray(void);
 int testPVType(void);
@@ -53,11 +60,14 @@ void pvDataAllTests(void)
 
     /* pv */
     runTest(testBitSetUtil);
+    runTest(testCompare);
     runTest(testConvert);
     runTest(testFieldBuilder);
     runTest(testIntrospect);
     runTest(testOperators);
     runTest(testPVData);
+    runTest(testPVDataFile);
+    runTest(testParallelArray);
     runTest(testPVScalarArray);
     runTest(testPVStructureArray);
     runTest(testPVType);
@@ -76,6 +86,10 @@ void pvDataAllTests(void)
     runTest(testEvent);
     runTest(testTimeStamp);
     runTest(testTimer);
+    runTest(testThreadPool);
+    runTest(testRingBuffer);
+    runTest(testLatency);
+    runTest(testAllocStats);
     runTest(testTypeCast);
 
     /* copy */